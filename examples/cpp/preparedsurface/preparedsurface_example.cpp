@@ -0,0 +1,112 @@
+// runs DropCutterJob and PushCutterJob objects from several threads at the same
+// time on one PreparedSurface, and checks them against jobs run one at a time.
+// Build it, and libocl, with -fsanitize=thread to look for data races between the jobs.
+//
+// usage: preparedsurface_example [file.stl] [threads]
+
+#include <string>
+#include <iostream>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include <opencamlib/stlsurf.hpp>
+#include <opencamlib/stlreader.hpp>
+#include <opencamlib/bullcutter.hpp>
+#include <opencamlib/preparedsurface.hpp>
+
+/// the drop-cutter points of job k, a grid over the surface, shifted with k
+static void addPoints(ocl::DropCutterJob& job, const ocl::Bbox& bb, int k) {
+    const int N = 40;
+    const double dx = (bb.maxpt.x-bb.minpt.x)/N;
+    const double dy = (bb.maxpt.y-bb.minpt.y)/N;
+    for (int i=0; i<=N; ++i) {
+        for (int j=0; j<=N; ++j) {
+            ocl::CLPoint p( bb.minpt.x + (i+0.1*k)*dx, bb.minpt.y + j*dy, bb.minpt.z-1 );
+            job.appendPoint( p );
+        }
+    }
+}
+
+/// the x- or y-fibers of job k, at a z-height that depends on k
+static void addFibers(ocl::PushCutterJob& job, const ocl::Bbox& bb, bool x, int k) {
+    const int N = 40;
+    const double z = bb.minpt.z + (bb.maxpt.z-bb.minpt.z)*(k+1)/10;
+    for (int i=0; i<=N; ++i) {
+        ocl::Fiber f;
+        if (x) {
+            double y = bb.minpt.y + i*(bb.maxpt.y-bb.minpt.y)/N;
+            f = ocl::Fiber( ocl::Point(bb.minpt.x-10, y, z), ocl::Point(bb.maxpt.x+10, y, z) );
+        } else {
+            double x0 = bb.minpt.x + i*(bb.maxpt.x-bb.minpt.x)/N;
+            f = ocl::Fiber( ocl::Point(x0, bb.minpt.y-10, z), ocl::Point(x0, bb.maxpt.y+10, z) );
+        }
+        job.appendFiber( f );
+    }
+}
+
+/// the result of one drop-cutter and one push-cutter job
+struct Result {
+    std::vector<double> z;
+    std::vector<unsigned int> intervals;
+    int dropCalls;
+    int pushCalls;
+    bool operator==(const Result& o) const {
+        return z == o.z && intervals == o.intervals && dropCalls == o.dropCalls && pushCalls == o.pushCalls;
+    }
+};
+
+/// run job k on ps
+static Result runJob(const ocl::PreparedSurface& ps, int k) {
+    const ocl::Bbox& bb = ps.getSTL().bb;
+    ocl::DropCutterJob drop(ps);
+    addPoints(drop, bb, k);
+    drop.run();
+    ocl::PushCutterJob push(ps, (k % 2) == 0);
+    addFibers(push, bb, (k % 2) == 0, k);
+    push.run();
+    Result r;
+    for (unsigned int n=0; n<drop.getPoints().size(); ++n)
+        r.z.push_back( drop.getPoints()[n].z );
+    for (unsigned int n=0; n<push.getFibers().size(); ++n)
+        r.intervals.push_back( push.getFibers()[n].size() );
+    r.dropCalls = drop.getCalls();
+    r.pushCalls = push.getCalls();
+    return r;
+}
+
+int main(int argc, char** argv) {
+    std::string file = (argc > 1) ? argv[1] : "../../../stl/demo.stl";
+    const int nthreads = (argc > 2) ? atoi(argv[2]) : 4;
+    ocl::STLSurf surf;
+    ocl::STLReader reader( std::wstring(file.begin(), file.end()), surf );
+    if ( surf.size() == 0 ) {
+        std::cout << "no triangles in " << file << "\n";
+        return 1;
+    }
+    ocl::BullCutter cutter(4.0, 1.0, 20.0);
+    ocl::PreparedSurface ps(surf, cutter);
+
+    // the reference, one job at a time
+    std::vector<Result> reference;
+    for (int k=0; k<nthreads; ++k)
+        reference.push_back( runJob(ps, k) );
+
+    // the same jobs, one per thread, all at the same time
+    std::vector<Result> results(nthreads);
+    std::vector<std::thread> threads;
+    for (int k=0; k<nthreads; ++k)
+        threads.push_back( std::thread( [&ps, &results, k]() { results[k] = runJob(ps, k); } ) );
+    for (unsigned int k=0; k<threads.size(); ++k)
+        threads[k].join();
+
+    int bad = 0;
+    for (int k=0; k<nthreads; ++k) {
+        if ( !(results[k] == reference[k]) ) {
+            std::cout << "job " << k << " differs from the reference\n";
+            ++bad;
+        }
+    }
+    std::cout << nthreads << " concurrent jobs on one PreparedSurface, " << bad << " differ from the reference.\n";
+    return bad ? 1 : 0;
+}
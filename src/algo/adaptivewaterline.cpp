@@ -25,10 +25,6 @@
 
 #include <boost/foreach.hpp> 
 
-#ifdef _OPENMP
-    #include <omp.h>
-#endif
-
 #include "millingcutter.hpp"
 #include "point.hpp"
 #include "triangle.hpp"
@@ -51,12 +47,6 @@ AdaptiveWaterline::AdaptiveWaterline() {
     subOp.push_back( new FiberPushCutter() );
     subOp[0]->setXDirection();
     subOp[1]->setYDirection();
-    nthreads=1;
-#ifdef _OPENMP
-    nthreads = omp_get_num_procs(); 
-    //omp_set_dynamic(0);
-    omp_set_nested(1);
-#endif
     sampling = 1.0;
     min_sampling = 0.1;
     cosLimit = 0.999;
@@ -87,60 +77,36 @@ void AdaptiveWaterline::adaptive_sampling_run() {
     Line* line = new Line( Point(minx,miny,zh) , Point(maxx,maxy,zh) );
     Span* linespan = new LineSpan(*line);
     
-#ifdef _WIN32 // OpenMP task not supported with the version 2 of VS2013 OpenMP
-	#pragma omp parallel sections
-	{
-		#pragma omp section // Replace OMP Task by Parallel sections
-		{ // first child
-#else
-#pragma omp parallel
-	{
-#pragma omp single nowait
-		{ // initial root task
-#pragma omp task
-			{ // first child task
-#endif // _WIN32
-				xfibers.clear();
-				Point xstart_p1 = Point(minx, linespan->getPoint(0.0).y, zh);
-				Point xstart_p2 = Point(maxx, linespan->getPoint(0.0).y, zh);
-				Point xstop_p1 = Point(minx, linespan->getPoint(1.0).y, zh);
-				Point xstop_p2 = Point(maxx, linespan->getPoint(1.0).y, zh);
-				Fiber xstart_f = Fiber(xstart_p1, xstart_p2);
-				Fiber xstop_f = Fiber(xstop_p1, xstop_p2);
-				subOp[0]->run(xstart_f);
-				subOp[0]->run(xstop_f);
-				xfibers.push_back(xstart_f);
-				std::cout << " XFiber adaptive sample \n";
-				xfiber_adaptive_sample(linespan, 0.0, 1.0, xstart_f, xstop_f);
-#ifdef _WIN32 // OpenMP task not supported with the version 2 of VS2013 OpenMP
-		}
-		#pragma omp section
-		{ // second child
-#else
-		}
-# pragma omp task
-			{ // second child task
-#endif // _WIN32
-				yfibers.clear();
-				Point ystart_p1 = Point(linespan->getPoint(0.0).x, miny, zh);
-				Point ystart_p2 = Point(linespan->getPoint(0.0).x, maxy, zh);
-				Point ystop_p1 = Point(linespan->getPoint(1.0).x, miny, zh);
-				Point ystop_p2 = Point(linespan->getPoint(1.0).x, maxy, zh);
-				Fiber ystart_f = Fiber(ystart_p1, ystart_p2);
-				Fiber ystop_f = Fiber(ystop_p1, ystop_p2);
-				subOp[1]->run(ystart_f);
-				subOp[1]->run(ystop_f);
-				yfibers.push_back(ystart_f);
-				std::cout << " YFiber adaptive sample \n";
-				yfiber_adaptive_sample(linespan, 0.0, 1.0, ystart_f, ystop_f);
-#ifdef _WIN32 // OpenMP task not supported with the version 2 of VS2013 OpenMP
-		}
-	} // end omp parallel
-#else
-            }
+    // the x- and y-fibers are independent, run them as two tasks
+    getExecutor().run( 2, [&](unsigned int k) {
+        if ( k == 0 ) {
+            xfibers.clear();
+            Point xstart_p1 = Point(minx, linespan->getPoint(0.0).y, zh);
+            Point xstart_p2 = Point(maxx, linespan->getPoint(0.0).y, zh);
+            Point xstop_p1 = Point(minx, linespan->getPoint(1.0).y, zh);
+            Point xstop_p2 = Point(maxx, linespan->getPoint(1.0).y, zh);
+            Fiber xstart_f = Fiber(xstart_p1, xstart_p2);
+            Fiber xstop_f = Fiber(xstop_p1, xstop_p2);
+            subOp[0]->run(xstart_f);
+            subOp[0]->run(xstop_f);
+            xfibers.push_back(xstart_f);
+            std::cout << " XFiber adaptive sample \n";
+            xfiber_adaptive_sample(linespan, 0.0, 1.0, xstart_f, xstop_f);
+        } else {
+            yfibers.clear();
+            Point ystart_p1 = Point(linespan->getPoint(0.0).x, miny, zh);
+            Point ystart_p2 = Point(linespan->getPoint(0.0).x, maxy, zh);
+            Point ystop_p1 = Point(linespan->getPoint(1.0).x, miny, zh);
+            Point ystop_p2 = Point(linespan->getPoint(1.0).x, maxy, zh);
+            Fiber ystart_f = Fiber(ystart_p1, ystart_p2);
+            Fiber ystop_f = Fiber(ystop_p1, ystop_p2);
+            subOp[1]->run(ystart_f);
+            subOp[1]->run(ystop_f);
+            yfibers.push_back(ystart_f);
+            std::cout << " YFiber adaptive sample \n";
+            yfiber_adaptive_sample(linespan, 0.0, 1.0, ystart_f, ystop_f);
         }
-    } // end omp parallel
-#endif // _WIN32
+    } );
 
     delete line;
     delete linespan;
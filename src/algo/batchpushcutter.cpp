@@ -19,17 +19,19 @@
  *  along with this program. If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
 #include <boost/foreach.hpp>
 #include <boost/progress.hpp>
 
-#ifdef _OPENMP  
-    #include <omp.h>
-#endif
-
 #include "millingcutter.hpp"
 #include "point.hpp"
 #include "triangle.hpp"
 #include "batchpushcutter.hpp"
+#include "stlsurf.hpp"
 
 namespace ocl
 {
@@ -39,35 +41,49 @@ namespace ocl
 BatchPushCutter::BatchPushCutter() {
     fibers = new std::vector<Fiber>();
     nCalls = 0;
-    nthreads = 1;
-#ifdef _OPENMP
-    nthreads = omp_get_num_procs(); // figure out how many cores we have
-#endif
     cutter = NULL;
     bucketSize = 1;
-    root = new KDTree<Triangle>();
 }
 
 BatchPushCutter::~BatchPushCutter() {
     delete fibers;
-    delete root;
 }
 
 void BatchPushCutter::setSTL(const STLSurf &s) {
     surf = &s;
-    // std::cout << "BPC::setSTL() Building kd-tree... bucketSize=" << bucketSize << "..";
-    root->setBucketSize( bucketSize );
-    if (x_direction)
-        root->setYZDimensions(); // we search for triangles in the XY plane, don't care about Z-coordinate
-    else if (y_direction)
-        root->setXZDimensions();
-    else {
+    if ( !x_direction && !y_direction ) {
         std::cerr << "ERROR: setXDirection() or setYDirection() must be called before setSTL() \n";
         assert(0);
     }
-    // std::cout << "BPC::setSTL() root->build()...";
-    root->build(s.tris);
-    // std::cout << "done.\n";
+    triangles.reset();
+    root.reset(); // built by buildIndex()
+}
+
+void BatchPushCutter::setTriangles(std::shared_ptr< const std::vector<const Triangle*> > t) {
+    triangles = t;
+    root.reset();
+}
+
+void BatchPushCutter::clearTriangles() {
+    if ( triangles ) {
+        triangles.reset();
+        root.reset();
+    }
+}
+
+void BatchPushCutter::buildIndex() {
+    SpatialIndex<Triangle>* index = newIndex();
+    index->setBucketSize( bucketSize );
+    if (x_direction)
+        index->setYZDimensions(); // we search for triangles in the XY plane, don't care about Z-coordinate
+    else
+        index->setXZDimensions();
+    if ( triangles ) {
+        index->build( *triangles );
+        root.reset( index );
+    } else {
+        root = surf->indexCache.get( indexType, index, surf->tris ); // shared by all Waterlines on s
+    }
 }
 
 void BatchPushCutter::appendFiber(Fiber& f) {
@@ -104,10 +120,12 @@ void BatchPushCutter::pushCutter2() {
     // std::cout << "BatchPushCutter2 with " << fibers->size() << 
     //           " fibers and " << surf->tris.size() << " triangles..." << std::endl;
     nCalls = 0;
-    std::list<Triangle>* overlap_triangles;
+    if ( !root )
+        buildIndex();
+    std::vector<const Triangle*> overlap_triangles;
     boost::progress_display show_progress( fibers->size() );
     BOOST_FOREACH(Fiber& f, *fibers) {
-        CLPoint cl;
+        Point cl;
         if (x_direction) {
             cl.x = 0;
             cl.y = f.p1.y;
@@ -119,17 +137,16 @@ void BatchPushCutter::pushCutter2() {
         } else {
             assert(0);
         }
-        overlap_triangles = root->search_cutter_overlap(cutter, &cl);
-        assert( overlap_triangles->size() <= surf->size() ); // can't possibly find more triangles than in the STLSurf 
-        BOOST_FOREACH( const Triangle& t, *overlap_triangles) {
+        root->search_cutter_overlap(cutter, &cl, overlap_triangles);
+        assert( overlap_triangles.size() <= surf->size() ); // can't possibly find more triangles than in the STLSurf 
+        BOOST_FOREACH( const Triangle* t, overlap_triangles) {
             //if ( bb->overlaps( t.bb ) ) {
                 Interval i;
-                cutter->pushCutter(f,i,t);
+                cutter->pushCutter(f,i,*t);
                 f.addInterval(i);
                 ++nCalls;
             //}
         }
-        delete( overlap_triangles );
         ++show_progress;
     }
     // std::cout << "BatchPushCutter2 done." << std::endl;
@@ -137,70 +154,97 @@ void BatchPushCutter::pushCutter2() {
 }
 
 /// use kd-tree search to find overlapping triangles
-/// use OpenMP for multi-threading
+/// share the fibers between the threads of the Executor
 void BatchPushCutter::pushCutter3() {
     // std::cout << "BatchPushCutter3 with " << fibers->size() << 
     //           " fibers and " << surf->tris.size() << " triangles." << std::endl;
     // std::cout << " cutter = " << cutter->str() << "\n";
-    nCalls = 0;
-    boost::progress_display show_progress( fibers->size() );
-#ifdef _OPENMP
-    std::cout << "OpenMP is enabled";
-    omp_set_num_threads(nthreads);
-    //omp_set_nested(1);
-#endif
-    std::list<Triangle>::iterator it,it_end;    // for looping over found triabgles
-    Interval* i;
-    std::list<Triangle>* tris;
-    std::vector<Fiber>& fiberr = *fibers;
-#ifdef _WIN32 // OpenMP version 2 of VS2013 OpenMP need signed loop variable
-	int n; // loop variable
-    int Nmax = fibers->size();         // the number of fibers to process
-#else
-    unsigned int n; // loop variable
-    unsigned int Nmax = fibers->size();         // the number of fibers to process
-#endif
-    unsigned int calls=0;
-    
-    #pragma omp parallel for schedule(dynamic) shared(calls, fiberr) private(n,i,tris,it,it_end)
-    //#pragma omp parallel for shared( calls, fiberr) private(n,i,tris,it,it_end)
-    for (n=0; n<Nmax; ++n) { // loop through all fibers
-#ifdef _OPENMP
-        if ( n== 0 ) { // first iteration
-            if (omp_get_thread_num() == 0 ) 
-                std::cout << "Number of OpenMP threads = "<< omp_get_num_threads() << "\n";
-        }
-#endif  
-        CLPoint cl; // cl-point on the fiber
-        if ( x_direction ) {
-            cl.x=0;
-            cl.y=fiberr[n].p1.y;
-            cl.z=fiberr[n].p1.z;
-        } else if (y_direction ) {
-            cl.x=fiberr[n].p1.x;
-            cl.y=0;
-            cl.z=fiberr[n].p1.z;
-        }
-        tris = root->search_cutter_overlap(cutter, &cl);
-        it_end = tris->end();
-        for ( it=tris->begin() ; it!=it_end ; ++it) { // loop through the found overlapping triangles
-            //if ( bb->overlaps( it->bb ) ) {
-                // todo: optimization where method-calls are skipped if triangle bbox already in the fiber
-                i = new Interval();
-                cutter->pushCutter(fiberr[n],*i,*it);  
-                fiberr[n].addInterval(*i); 
-                ++calls;
-                delete i;
-            //}
-        }
-        delete( tris );
-        ++show_progress;
-    } // OpenMP parallel region ends here
-    
-    this->nCalls = calls;
+    std::vector<BatchPushCutter*> ops(1, this);
+    runAll( getExecutor(), ops );
     // std::cout << "\nBatchPushCutter3 done." << std::endl;
     return;
 }
 
+unsigned int BatchPushCutter::pushFiber(Fiber& f, std::vector<const Triangle*>& tris) const {
+    Point cl; // cl-point on the fiber
+    if ( x_direction ) {
+        cl.x=0;
+        cl.y=f.p1.y;
+        cl.z=f.p1.z;
+    } else if (y_direction ) {
+        cl.x=f.p1.x;
+        cl.y=0;
+        cl.z=f.p1.z;
+    }
+    root->search_cutter_overlap(cutter, &cl, tris);
+    std::vector<const Triangle*>::const_iterator it, it_end = tris.end();
+    for ( it=tris.begin() ; it!=it_end ; ++it) { // loop through the found overlapping triangles
+        // todo: optimization where method-calls are skipped if triangle bbox already in the fiber
+        Interval i;
+        cutter->pushCutter(f,i,**it);  
+        f.addInterval(i); 
+    }
+    return tris.size();
+}
+
+// the fibers of all ops are numbered one after the other, and split between the threads as one range
+void BatchPushCutter::runAll(Executor& ex, const std::vector<BatchPushCutter*>& ops) {
+    std::vector<unsigned int> first(1, 0); // index of the first fiber of each op, and the total
+    BOOST_FOREACH( const BatchPushCutter* op, ops ) {
+        first.push_back( first.back() + op->fibers->size() );
+    }
+    boost::progress_display show_progress( first.back() );
+    std::mutex progress; // guards show_progress
+    std::cout << "Number of threads = " << ex.concurrency() << "\n";
+    // the kd-tree of an op is built by the first chunk that reaches one of its fibers, while the
+    // other chunks of that op wait. The tasks work through the range from the front of their
+    // parts, so only a few ops at a time have a kd-tree.
+    std::unique_ptr<std::once_flag[]> built( new std::once_flag[ ops.size() ] );
+    auto reached = [&](unsigned int k) {
+        std::call_once( built[k], [&]() {
+            if ( !ops[k]->root )
+                ops[k]->buildIndex();
+        } );
+    };
+    // search results and call counts per slot, re-used for all fibers of the slot
+    std::vector< std::vector<const Triangle*> > tris( ex.concurrency() );
+    std::vector<unsigned int> calls( ex.concurrency()*ops.size(), 0 );
+    // the fibers of each op not yet pushed. The thread that pushes the last one frees the
+    // triangles of the op and their kd-tree.
+    std::vector< std::atomic<unsigned int> > left( ops.size() );
+    for (unsigned int k=0; k<ops.size(); ++k)
+        left[k] = first[k+1] - first[k];
+    auto pushed = [&](unsigned int k, unsigned int done) {
+        if ( done > 0 && left[k].fetch_sub( done ) == done )
+            ops[k]->clearTriangles();
+    };
+    parallel_for( ex, first.back(), 1, [&](unsigned int begin, unsigned int end, unsigned int slot) {
+        // the op of fiber begin
+        unsigned int k = std::upper_bound( first.begin(), first.end(), begin ) - first.begin() - 1;
+        unsigned int done = 0; // fibers of op k pushed by this chunk
+        reached( k );
+        for (unsigned int n=begin; n<end; ++n) { // loop through the fibers of this chunk
+            while ( n >= first[k+1] ) {
+                pushed( k, done );
+                done = 0;
+                ++k;
+                if ( n < first[k+1] )
+                    reached( k );
+            }
+            calls[ slot*ops.size() + k ] += ops[k]->pushFiber( (*ops[k]->fibers)[ n-first[k] ], tris[slot] );
+            ++done;
+        }
+        pushed( k, done );
+        std::lock_guard<std::mutex> lock( progress );
+        show_progress += end-begin;
+    } );
+    for (unsigned int k=0; k<ops.size(); ++k) {
+        ops[k]->clearTriangles(); // an op without fibers
+        ops[k]->nCalls = 0;
+        for (unsigned int slot=0; slot<ex.concurrency(); ++slot)
+            ops[k]->nCalls += calls[ slot*ops.size() + k ];
+    }
+}
+
 }// end namespace
 // end file batchpushcutter.cpp
@@ -23,6 +23,8 @@
 #define BPC_H
 
 #include <iostream>
+#include <list>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -48,8 +50,16 @@ class BatchPushCutter : public Operation {
         BatchPushCutter();
         virtual ~BatchPushCutter();
         
-        /// set the STL-surface and build kd-tree
+        /// set the STL-surface. The kd-tree over all of it is built by the first run,
+        /// or shared with other operations through STLSurf::indexCache.
         void setSTL(const STLSurf& s);
+        /// push against the triangles t of the STL-surface only, instead of all of it. The kd-tree
+        /// is built over t by the next run, and t must contain all triangles the fibers can reach.
+        /// Call after setSTL(). The run frees t and its kd-tree when it is done, see clearTriangles().
+        void setTriangles(std::shared_ptr< const std::vector<const Triangle*> > t);
+        /// free the triangles set with setTriangles() and their kd-tree. The next run
+        /// uses the whole STL-surface.
+        void clearTriangles();
 
         /// set this bpc to be x-direction
         void setXDirection() {x_direction=true;y_direction=false;}
@@ -65,7 +75,18 @@ class BatchPushCutter : public Operation {
         
         std::vector<Fiber>* getFibers() const {return fibers;}
         void reset();
+        
+        /// run push-cutter on the fibers of all ops as one parallel loop on ex, so that
+        /// the threads share the work of all ops, e.g. the x- and y-fibers of a Waterline.
+        /// The kd-tree of an op is built when its first fiber is pushed, and the triangles set with
+        /// setTriangles() and their kd-tree are freed as soon as its last fiber is done.
+        static void runAll(Executor& ex, const std::vector<BatchPushCutter*>& ops);
     protected:
+        /// build root over triangles, or get the one for the whole surface from the cache
+        void buildIndex();
+        /// push the cutter along f against the triangles the kd-tree finds,
+        /// using tris for the search result. Returns the number of push-cutter calls.
+        unsigned int pushFiber(Fiber& f, std::vector<const Triangle*>& tris) const;
         /// 1st version of algorithm
         void pushCutter1();
         /// 2nd version of algorithm
@@ -75,6 +96,8 @@ class BatchPushCutter : public Operation {
         
         /// pointer to list of Fibers
         std::vector<Fiber>* fibers;
+        /// the triangles set with setTriangles(), or none for the whole surface
+        std::shared_ptr< const std::vector<const Triangle*> > triangles;
         
     // DATA
         /// true if this we have only x-direction fibers
@@ -19,6 +19,9 @@
  *  along with this program. If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
+#include <cassert>
+
 #include <boost/foreach.hpp>
 
 #include "fiber.hpp"
@@ -38,56 +41,49 @@ void Fiber::calcDir() {
     dir.normalize();
 }
 
+/// true if interval i ends below t, for std::lower_bound() on Fiber::ints
+static bool endsBelow(const Interval& i, double t) {
+    return i.upper < t;
+}
+
+// only the first interval that does not end below i can contain it
 bool Fiber::contains(Interval& i) const {
-    BOOST_FOREACH( Interval fi, ints) {
-        if ( i.inside( fi ) )
-            return true;
-    }
-    return false;
+    std::vector<Interval>::const_iterator fi = std::lower_bound( ints.begin(), ints.end(), i.lower, endsBelow );
+    return ( fi != ints.end() && i.inside( *fi ) );
 }
 
 bool Fiber::missing(Interval& i) const {
-    bool result = true;
-    BOOST_FOREACH( Interval fi, ints) {
-        if ( !i.outside( fi ) ) // all existing ints must be non-overlapping
-            result = false; 
-    }
-    return result;
+    std::vector<Interval>::const_iterator fi = std::lower_bound( ints.begin(), ints.end(), i.lower, endsBelow );
+    return ( fi == ints.end() || i.upper < fi->lower );
 }
 
 void Fiber::addInterval(Interval& i) {
     if (i.empty())
         return; // do nothing.
     
-    if (ints.empty()) { // empty fiber case
-        ints.push_back(i); 
+    // the intervals that overlap i are the range [first, last) of ints
+    std::vector<Interval>::iterator first, last;
+    first = std::lower_bound( ints.begin(), ints.end(), i.lower, endsBelow );
+    last = first;
+    while ( last != ints.end() && !( i.upper < last->lower ) )
+        ++last;
+    
+    if ( first == last ) { // if fiber doesn't contain i
+        ints.insert(first, i); // keeps ints sorted
         return;
-    } else if ( this->contains(i)  ) { // if fiber already contains i  
+    } else if ( last-first == 1 && i.inside( *first ) ) { // if fiber already contains i
         return; // do nothing
-    } else if ( this->missing(i) ) { // if fiber doesn't contain i 
-        ints.push_back(i);
-        return;
     } else {
-        // this is the messier general case with partial overlap
-        std::vector<Interval>::iterator itr;
-        itr = ints.begin();
-        std::vector<Interval> overlaps;
-        while (itr!=ints.end()) { // loop through all intervals
-            if ( ! (itr->outside( i )) ) {
-                overlaps.push_back(*itr); // add overlaps here
-                itr = ints.erase(itr); // erase overlaps from ints
-            } else {
-                ++itr;
-            }
-        }
-        overlaps.push_back(i);
-        // now build a new interval from i and the overlaps
-        Interval sumint;        
-        BOOST_FOREACH(Interval intr, overlaps) {
-            sumint.updateLower( intr.lower, intr.lower_cc );
-            sumint.updateUpper( intr.upper, intr.upper_cc );
+        // partial overlap, build a new interval from the overlaps and i
+        Interval sumint;
+        for (std::vector<Interval>::iterator itr=first; itr!=last; ++itr) {
+            sumint.updateLower( itr->lower, itr->lower_cc );
+            sumint.updateUpper( itr->upper, itr->upper_cc );
         }
-        ints.push_back(sumint); // add the sum-interval to ints
+        sumint.updateLower( i.lower, i.lower_cc );
+        sumint.updateUpper( i.upper, i.upper_cc );
+        *first = sumint; // it replaces the overlaps, in the place of the first one
+        ints.erase(first+1, last);
         return;
     }
 }
@@ -105,7 +101,7 @@ Point Fiber::point(double t) const {
 
 void Fiber::printInts() const {
     int n=0;
-    BOOST_FOREACH( Interval i, ints) {
+    BOOST_FOREACH( const Interval& i, ints) {
         std::cout << n << ": [ " << i.lower << " , " << i.upper << " ]" << "\n";
         ++n;
     }
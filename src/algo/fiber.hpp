@@ -38,7 +38,7 @@ class Fiber {
         /// create a Fiber between points p1 and p2
         Fiber(const Point &p1, const Point &p2);
         virtual ~Fiber() {}
-        /// add an interval to this Fiber
+        /// add an interval to this Fiber. Intervals that overlap i are merged with it into one.
         void addInterval(Interval& i);
         /// return true if Fiber already has interval i in it
         bool contains(Interval& i) const;
@@ -79,7 +79,8 @@ class Fiber {
         Point p1;  ///< start point
         Point p2;  ///< end point
         Point dir; ///< direction vector (normalized)
-        std::vector<Interval> ints; ///< the intervals in this Fiber
+        /// the intervals in this Fiber, sorted by lower. They never overlap, so they are sorted by upper too.
+        std::vector<Interval> ints;
     protected:
         /// set the direction(tangent) vector
         void calcDir();
@@ -22,10 +22,6 @@
 #include <boost/foreach.hpp>
 #include <boost/progress.hpp>
 
-#ifdef _OPENMP  
-    #include <omp.h>
-#endif
-
 #include "millingcutter.hpp"
 #include "point.hpp"
 #include "triangle.hpp"
@@ -38,33 +34,28 @@ namespace ocl
 
 FiberPushCutter::FiberPushCutter() {
     nCalls = 0;
-    nthreads = 1;
-#ifdef _OPENMP
-    nthreads = omp_get_num_procs(); // figure out how many cores we have
-#endif
     cutter = NULL;
     bucketSize = 1;
-    root = new KDTree<Triangle>();
 }
 
 FiberPushCutter::~FiberPushCutter() {
-    delete root;
 }
 
 void FiberPushCutter::setSTL(const STLSurf &s) {
     surf = &s;
     std::cout << "BPC::setSTL() Building kd-tree... bucketSize=" << bucketSize << "..";
-    root->setBucketSize( bucketSize );
+    SpatialIndex<Triangle>* index = newIndex();
+    index->setBucketSize( bucketSize );
     if (x_direction)
-        root->setYZDimensions(); 
+        index->setYZDimensions(); 
     else if (y_direction)
-        root->setXZDimensions();
+        index->setXZDimensions();
     else {
         std::cout << " ERROR: setXDirection() or setYDirection() must be called before setSTL() \n";
         assert(0);
     }
     std::cout << "BPC::setSTL() root->build()";
-    root->build(s.tris);
+    root = s.indexCache.get( indexType, index, s.tris );
     std::cout << " done.\n";
 }
 
@@ -79,10 +70,8 @@ void FiberPushCutter::pushCutter1(Fiber& f) {
 }
 
 void FiberPushCutter::pushCutter2(Fiber& f) {
-    std::list<Triangle>::iterator it,it_end;    // for looping over found triangles
-    Interval* i;
-    std::list<Triangle>* tris;
-    CLPoint cl;
+    std::vector<const Triangle*>::const_iterator it,it_end;    // for looping over found triangles
+    Point cl;
     if ( x_direction ) {
         cl.x=0;
         cl.y=f.p1.y;
@@ -92,16 +81,14 @@ void FiberPushCutter::pushCutter2(Fiber& f) {
         cl.y=0;
         cl.z=f.p1.z;
     }
-    tris = root->search_cutter_overlap(cutter, &cl);
-    it_end = tris->end();
-    for ( it=tris->begin() ; it!=it_end ; ++it) {
-		i = new Interval();
-		cutter->pushCutter(f,*i,*it);
-		f.addInterval(*i); 
+    root->search_cutter_overlap(cutter, &cl, tris);
+    it_end = tris.end();
+    for ( it=tris.begin() ; it!=it_end ; ++it) {
+		Interval i;
+		cutter->pushCutter(f,i,**it);
+		f.addInterval(i); 
 		++nCalls;
-		delete i;
     }
-    delete( tris );
 }
 
 }// end namespace
@@ -64,6 +64,8 @@ class FiberPushCutter : public Operation {
         bool x_direction;
         /// true if we have y-direction fibers
         bool y_direction;
+        /// triangles found by the kd-tree search, re-used between calls to run(Fiber&)
+        std::vector<const Triangle*> tris;
 };
 
 } // end namespace
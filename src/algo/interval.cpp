@@ -22,6 +22,7 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <cassert>
 
 #include "interval.hpp"
 
@@ -33,14 +34,12 @@ Interval::Interval() {
     upper = 0.0;
     lower_cc = CCPoint();
     upper_cc = CCPoint();
-    in_weave=false;
 }
 
 Interval::Interval(const double l, const double u) {
     assert( l <= u );
     lower = l;
     upper = u;
-    in_weave=false;
 }
 
 void Interval::update(const double t, CCPoint& p) {
@@ -62,16 +61,12 @@ void Interval::updateUpper(const double t, CCPoint& p) {
     if (upper_cc.type == NONE) {
         upper = t;
         lower = t;
-        CCPoint* tmp = new CCPoint(p);
-        upper_cc = *tmp;
-        lower_cc = *tmp;
-        delete tmp;
+        upper_cc = p;
+        lower_cc = p;
     }
     if ( t > upper ) {
         upper = t;
-        CCPoint* tmp = new CCPoint(p);
-        upper_cc = *tmp;
-        delete tmp;
+        upper_cc = p;
     } 
 }
 
@@ -79,16 +74,12 @@ void Interval::updateLower(const double t, CCPoint& p) {
     if (lower_cc.type == NONE) {
         lower = t;
         upper = t;
-        CCPoint* tmp = new CCPoint(p);
-        lower_cc = *tmp;
-        upper_cc = *tmp;
-        delete tmp;
+        lower_cc = p;
+        upper_cc = p;
     }
     if ( t < lower ) {
         lower = t; 
-        CCPoint* tmp = new CCPoint(p);
-        lower_cc = *tmp;
-        delete tmp;
+        lower_cc = p;
     }
 }
 
@@ -21,25 +21,23 @@
 #ifndef INTERVAL_HPP
 #define INTERVAL_HPP
 
-#include <vector>
-//#include <pair>
+#include <string>
 
 #include "ccpoint.hpp"
-//#include "weave_typedef.hpp"
-#include "halfedgediagram.hpp"
 
 namespace ocl {
 
-class Fiber;
-
 /// interval for use by fiber and weave
 /// a parameter interval [upper, lower]
+///
+/// An Interval is only the push-cutter result: the t-values and cc-points at its ends.
+/// It is created for every triangle a fiber is tested against, so it is kept small. The
+/// Weave keeps its own bookkeeping for each interval, see weave::IntervalProps.
 class Interval {
     public:
         Interval();
         /// create and interval [l,u]  (is this ever called??)
         Interval(const double l, const double u);
-        virtual ~Interval() {};
         
         /// update upper with t, and corresponding cc-point p
         void updateUpper(const double t, CCPoint& p);
@@ -64,33 +62,6 @@ class Interval {
         CCPoint lower_cc; ///< cutter contact point corresponding to lower
         double upper;  ///< the upper t-value 
         double lower; ///< the lower t-value
-        bool in_weave;  ///< flag for use by Weave::build()
-        std::set<std::vector<Fiber>::iterator> intersections_fibers; ///< fibers
-        
-        /// intersections with other intervals are stored in this set of
-        /// VertexPairs of type std::pair<VertexDescriptor, double>
-        
-        typedef boost::adjacency_list_traits<boost::listS, 
-                                     boost::listS, 
-                                     boost::bidirectionalS, 
-                                     boost::listS >::vertex_descriptor WeaveVertex;
-        typedef std::pair< WeaveVertex, double > VertexPair;
-
-        /// compare based on pair.second, the coordinate of the intersection
-        struct VertexPairCompare {
-            /// comparison operator
-            bool operator() (const VertexPair& lhs, const VertexPair& rhs) const
-            { return lhs.second < rhs.second ;}
-        };
-
-        /// intersections stored in this set (for rapid finding of neighbors etc)
-        typedef std::set< VertexPair, VertexPairCompare > VertexIntersectionSet;
-        
-        // this is the same type as ocl::weave::VertexPairIterator, but redefined here anywhere
-        typedef VertexIntersectionSet::iterator VertexPairIterator;    
-
-        
-        VertexIntersectionSet intersections2;
 };
 
 } // end namespace
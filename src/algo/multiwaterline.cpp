@@ -0,0 +1,107 @@
+/*  $Id$
+ * 
+ *  Copyright (c) 2010-2011 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *  
+ *  This file is part of OpenCAMlib 
+ *  (see https://github.com/aewallin/opencamlib).
+ *  
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+
+#include <boost/foreach.hpp>
+
+#include "multiwaterline.hpp"
+#include "waterline.hpp"
+#include "batchpushcutter.hpp"
+
+namespace ocl
+{
+
+MultiWaterline::MultiWaterline() {
+    nCalls = 0;
+    cutter = NULL;
+    surf = NULL;
+    sampling = 1.0;
+    bucketSize = 1;
+}
+
+void MultiWaterline::run() {
+    runLevels(false);
+}
+
+void MultiWaterline::run2() {
+    runLevels(true);
+}
+
+void MultiWaterline::runLevels(bool smart) {
+    Executor& ex = getExecutor();
+    loops.assign( zlevels.size(), std::vector< std::vector<Point> >() );
+    nCalls = 0;
+    // the levels are run in groups, so that only the fibers of one group are held at a time
+    const unsigned int group = LEVELS_PER_THREAD*ex.concurrency();
+    std::cout << "MultiWaterline " << zlevels.size() << " levels, in groups of " << group << ".\n";
+    for (unsigned int first=0; first<zlevels.size(); first+=group)
+        runGroup( ex, first, std::min( first+group, (unsigned int)zlevels.size() ), smart );
+}
+
+void MultiWaterline::runGroup(Executor& ex, unsigned int first, unsigned int last, bool smart) {
+    // one Waterline per level, set up like this operation. A level pushes against the
+    // triangles near its z-height only, or against the whole surface when these are many,
+    // see Waterline::init_fibers(). runAll() builds the kd-tree of a level when it reaches
+    // its fibers, and frees it as soon as they are pushed.
+    std::vector<Waterline*> levels;
+    std::vector<BatchPushCutter*> ops;
+    for (unsigned int n=first; n<last; ++n) {
+        const double z = zlevels[n];
+        Waterline* w = new Waterline();
+        w->setExecutor( executor );
+        w->setIndexType( indexType );
+        w->setBucketSize( bucketSize );
+        w->setSTL( *surf );
+        w->setCutter( cutter );
+        w->setSampling( sampling );
+        w->setZ( z );
+        w->init_fibers();
+        ops.push_back( static_cast<BatchPushCutter*>( w->subOp[0] ) );
+        ops.push_back( static_cast<BatchPushCutter*>( w->subOp[1] ) );
+        levels.push_back( w );
+    }
+    BatchPushCutter::runAll( ex, ops );
+    BOOST_FOREACH( const BatchPushCutter* op, ops ) {
+        nCalls += op->getCalls();
+    }
+    
+    // the weaves are independent, each level is woven by one task
+    parallel_for( ex, levels.size(), 1, [&](unsigned int begin, unsigned int end, unsigned int slot) {
+        for (unsigned int n=begin; n<end; ++n) {
+            Waterline& w = *levels[n];
+            w.xfibers = *( w.subOp[0]->getFibers() );
+            w.yfibers = *( w.subOp[1]->getFibers() );
+            if ( smart )
+                w.weave_process2();
+            else
+                w.weave_process();
+            loops[first+n].swap( w.loops );
+            w.reset(); // the fibers are not needed any more
+        }
+    } );
+    BOOST_FOREACH( Waterline* w, levels ) {
+        delete w;
+    }
+}
+
+} // end namespace
+// end file multiwaterline.cpp
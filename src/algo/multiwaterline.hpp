@@ -0,0 +1,82 @@
+/*  $Id$
+ * 
+ *  Copyright (c) 2010-2011 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *  
+ *  This file is part of OpenCAMlib 
+ *  (see https://github.com/aewallin/opencamlib).
+ *  
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MULTIWATERLINE_H
+#define MULTIWATERLINE_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "point.hpp"
+#include "operation.hpp"
+
+namespace ocl
+{
+
+///
+/// \brief waterlines at many z-heights, computed together
+///
+/// MultiWaterline gives the same loops as one Waterline per z-height, but runs the
+/// levels together, in groups of LEVELS_PER_THREAD levels per thread: the x- and y-fibers
+/// of all levels of a group are pushed as one parallel batch, and the weaves of the levels
+/// are built in parallel. The fibers of a group are held in memory until its weaves are
+/// built, so the memory used grows with the group size, not with the number of levels.
+class MultiWaterline : public Operation {
+    public:
+        MultiWaterline();
+        virtual ~MultiWaterline() {}
+        /// add a waterline at height z
+        void appendZ(const double z) {zlevels.push_back(z);}
+        /// set the z-heights, replacing any earlier ones
+        void setZ(const std::vector<double>& z) {zlevels = z;}
+        /// return the z-heights
+        const std::vector<double>& getZ() const {return zlevels;}
+        /// run the waterlines at all z-heights, with Waterline::run().
+        /// setSTL, setCutter, setSampling, and setZ or appendZ must be called first.
+        void run();
+        /// run the waterlines at all z-heights, with Waterline::run2()
+        void run2();
+        /// return the loops of the waterline at the n:th z-height
+        const std::vector< std::vector<Point> >& getLoops(unsigned int n) const {return loops[n];}
+        /// return the loops of all levels, in the order of getZ()
+        const std::vector< std::vector< std::vector<Point> > >& getLoops() const {return loops;}
+        /// clear the result
+        void reset() {loops.clear();}
+        
+    protected:
+        /// run all levels, with Waterline::weave_process2() if smart is true
+        void runLevels(bool smart);
+        /// run the levels [first, last) on ex, with Waterline::weave_process2() if smart is true
+        void runGroup(Executor& ex, unsigned int first, unsigned int last, bool smart);
+        /// the number of levels run together is this many per thread
+        static const unsigned int LEVELS_PER_THREAD = 4;
+    // DATA
+        /// the z-heights
+        std::vector<double> zlevels;
+        /// the loops of each level
+        std::vector< std::vector< std::vector<Point> > > loops;
+};
+
+} // end namespace
+
+#endif
+// end file multiwaterline.hpp
@@ -29,6 +29,11 @@
 #include "point.hpp"
 #include "fiber.hpp"
 #include "kdtree.hpp"
+#include "flatkdtree.hpp"
+#include "sahkdtree.hpp"
+#include "bvh.hpp"
+#include "indexcache.hpp"
+#include "executor.hpp"
 
 namespace ocl
 {
@@ -37,12 +42,19 @@ class STLSurf;
 class Triangle;
 class MillingCutter;
 
+/// the type of spatial index an Operation builds in setSTL()
+enum IndexType {KDTREE,       ///< KDTree, one heap-allocated KDNode per node
+                FLAT_KDTREE,  ///< FlatKDTree, nodes and buckets in contiguous arrays
+                SAH_KDTREE,   ///< SAHKDTree, a FlatKDTree with cost-based cuts, built in parallel
+                BVH4          ///< BVH, a bounding volume hierarchy with 4-wide nodes
+               };
+
 /// \brief base-class for low-level cam algorithms
 ///
 /// base-class for cam algorithms
 class Operation {
     public:
-        Operation() {}
+        Operation() : indexType(KDTREE), nthreads( ThreadPool::hardwareThreads() ) {}
         virtual ~Operation() {
             //std::cout << "~Operation()\n";
         }
@@ -60,15 +72,27 @@ class Operation {
                 op->setCutter(cutter);
             }
         }
-        /// set number of OpenMP threads. Defaults to OpenMP::omp_get_num_procs()
+        /// set number of threads. Defaults to the number of hardware threads.
+        /// The Operation runs on the process-wide ThreadPool::shared(n), and stops using
+        /// any Executor given with setExecutor().
         void setThreads(unsigned int n) {
             nthreads = n;
+            executor.reset();
             BOOST_FOREACH(Operation* op, subOp) {
                 op->setThreads(nthreads);
             }
         }
-        /// return number of OpenMP threads
+        /// return number of threads
         int  getThreads() const {return nthreads;}
+        /// run the parallel loops of this Operation and all sub-operations on e, e.g. a
+        /// thread pool shared with the host application. Sets the number of threads to e->concurrency().
+        void setExecutor(std::shared_ptr<Executor> e) {
+            executor = e;
+            nthreads = e->concurrency();
+            BOOST_FOREACH(Operation* op, subOp) {
+                op->setExecutor(executor);
+            }
+        }
         /// return the kd-tree bucket-size
         int getBucketSize() const {return bucketSize;}
         /// set the kd-tree bucket-size
@@ -78,6 +102,15 @@ class Operation {
                 op->setBucketSize(bucketSize);
             }
         }
+        /// set the type of spatial index built by setSTL()
+        void setIndexType(IndexType t) {
+            indexType = t;
+            BOOST_FOREACH(Operation* op, subOp) {
+                op->setIndexType(indexType);
+            }
+        }
+        /// return the type of spatial index built by setSTL()
+        IndexType getIndexType() const {return indexType;}
         /// return number of low-level calls
         int getCalls() const {return nCalls;}
         
@@ -119,6 +152,28 @@ class Operation {
         virtual std::vector<Fiber>* getFibers() const {return 0;}
         
     protected:
+        /// return the Executor set with setExecutor(), or the shared pool of nthreads threads
+        Executor& getExecutor() {
+            if ( !executor )
+                executor = ThreadPool::shared(nthreads);
+            return *executor;
+        }
+        /// return a new, empty, spatial index of type indexType. An index that builds in
+        /// parallel does so on the Executor of this Operation.
+        SpatialIndex<Triangle>* newIndex() {
+            if (indexType == FLAT_KDTREE)
+                return new FlatKDTree<Triangle>();
+            if (indexType == SAH_KDTREE) {
+                SAHKDTree<Triangle>* sah = new SAHKDTree<Triangle>();
+                getExecutor();
+                sah->setExecutor( executor );
+                return sah;
+            }
+            if (indexType == BVH4)
+                return new BVH<Triangle>();
+            return new KDTree<Triangle>();
+        }
+        
         /// sampling interval
         double sampling;
         /// how many low-level calls were made
@@ -129,10 +184,14 @@ class Operation {
         const MillingCutter* cutter;
         /// the STLSurf which we test against.
         const STLSurf* surf;
-        /// root of a kd-tree
-        KDTree<Triangle>* root;
+        /// the spatial index of the STLSurf triangles, shared through STLSurf::indexCache
+        IndexCache<Triangle>::Index root;
+        /// the type of spatial index built by setSTL()
+        IndexType indexType;
         /// number of threads to use
         unsigned int nthreads;
+        /// runs the parallel loops, see getExecutor()
+        std::shared_ptr<Executor> executor;
         /// sub-operations, if any, of this operation
         std::vector<Operation*> subOp;
 };
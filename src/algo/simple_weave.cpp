@@ -31,11 +31,11 @@ namespace ocl
 namespace weave
 {
 
-std::pair<Vertex,Vertex> SimpleWeave::find_neighbor_vertices( VertexPair v_pair, Interval& ival) {
-    Interval::VertexPairIterator itr = ival.intersections2.lower_bound( v_pair ); // returns first that is not less than argument (equal or greater)
+std::pair<Vertex,Vertex> SimpleWeave::find_neighbor_vertices( VertexPair v_pair, IntervalProps& ival) {
+    VertexPairIterator itr = ival.intersections2.lower_bound( v_pair ); // returns first that is not less than argument (equal or greater)
     assert( itr != ival.intersections2.end() ); // we must find a lower_bound
-    Interval::VertexPairIterator v_above = itr; // lower_bound returns one beyond the give key, i.e. what we want
-    Interval::VertexPairIterator v_below = --itr; // this is the vertex below the give vertex
+    VertexPairIterator v_above = itr; // lower_bound returns one beyond the give key, i.e. what we want
+    VertexPairIterator v_below = --itr; // this is the vertex below the give vertex
     std::pair<Vertex,Vertex> out;
     out.first = v_above->first; // vertex above v (xu)
     out.second = v_below->first; // vertex below v (xl)
@@ -63,6 +63,7 @@ void SimpleWeave::build() {
     // provide this "via" connection
     //int n_xfiber=0;
     // std::cout << " SimpleWeave::build()... \n";
+    initIntervalProps();
     BOOST_FOREACH( Fiber& xf, xfibers) {
         assert( !xf.empty() ); // no empty fibers please
         BOOST_FOREACH( Interval& xi, xf.ints ) {
@@ -70,13 +71,14 @@ void SimpleWeave::build() {
             double xmin = xf.point(xi.lower).x;
             double xmax = xf.point(xi.upper).x;
             if ( (xmax-xmin) > 0) {
-            assert( !xi.in_weave ); // this is the first time the x-interval is added!
-            xi.in_weave = true;
+            IntervalProps& xp = xprops( xf, xi );
+            assert( !xp.in_weave ); // this is the first time the x-interval is added!
+            xp.in_weave = true;
             // add the X interval end-points to the weave
             Point p1( xf.point(xi.lower) );
-            Vertex xv1 = add_cl_vertex( p1, xi, p1.x );
+            Vertex xv1 = add_cl_vertex( p1, xp, p1.x );
             Point p2( xf.point(xi.upper) );
-            Vertex xv2 = add_cl_vertex( p2, xi, p2.x );
+            Vertex xv2 = add_cl_vertex( p2, xp, p2.x );
             Edge e1 = g.add_edge(xv1,xv2); 
             Edge e2 = g.add_edge(xv2,xv1); 
 
@@ -96,12 +98,13 @@ void SimpleWeave::build() {
                             // there is an actual intersection btw x-interval and y-interval
                             // X interval xi on fiber xf intersects with Y interval yi on fiber yf
                             // intersection is at ( yf.p1.x, xf.p1.y , xf.p1.z )
-                            if (!yi.in_weave) { // add y-interval endpoints to weave
+                            IntervalProps& yp = yprops( yf, yi );
+                            if (!yp.in_weave) { // add y-interval endpoints to weave
                                 Point yp1( yf.point(yi.lower) );
-                                add_cl_vertex( yp1, yi, yp1.y );
+                                add_cl_vertex( yp1, yp, yp1.y );
                                 Point yp2( yf.point(yi.upper) );
-                                add_cl_vertex( yp2, yi, yp2.y );
-                                yi.in_weave = true;
+                                add_cl_vertex( yp2, yp, yp2.y );
+                                yp.in_weave = true;
                             }
                             // 3) intersection point, of type INT
                             
@@ -112,14 +115,14 @@ void SimpleWeave::build() {
                             Vertex x_u, x_l;
                             
                             //std::cout << " fins neighbor to x= " << v_position.x << "\n";
-                            boost::tie( x_u, x_l ) = find_neighbor_vertices( VertexPair(v, v_position.x), xi );
+                            boost::tie( x_u, x_l ) = find_neighbor_vertices( VertexPair(v, v_position.x), xp );
                             //std::cout << "found: x_u , x_l : " << x_u << " , " << x_l << "\n";
                             Vertex y_u, y_l;
-                            boost::tie( y_u, y_l ) = find_neighbor_vertices( VertexPair(v, v_position.y), yi );
+                            boost::tie( y_u, y_l ) = find_neighbor_vertices( VertexPair(v, v_position.y), yp );
                             
                             //std::cout << "found: y_u , y_l : " << y_u << " , " << y_l << "\n";
                             
-                            add_int_vertex(v_position,x_l,x_u,y_l,y_u,xi,yi);
+                            add_int_vertex(v_position,x_l,x_u,y_l,y_u,xp,yp);
                         } // end intersection case
                     } // end y interval loop
                 } // end if(potential intersection)
@@ -127,8 +130,8 @@ void SimpleWeave::build() {
             
             // now we've added an x-interval, we've gone through all the y-intervals
             // if there isn't a single intersecting interval, then remove the x-interval as it is useless
-            assert( xi.intersections2.size() >= 2  );
-            if ( xi.intersections2.size() == 2 ) {
+            assert( xp.intersections2.size() >= 2  );
+            if ( xp.intersections2.size() == 2 ) {
                 clVertexSet.erase(xv1);
                 clVertexSet.erase(xv2);
                 g.clear_vertex(xv1); 
@@ -144,11 +147,11 @@ void SimpleWeave::build() {
 }
 
 // add a new CL-vertex to Weave, also adding it to the interval intersection-set, and to clVertices
-Vertex SimpleWeave::add_cl_vertex( const Point& position, Interval& ival, double ipos) {
+Vertex SimpleWeave::add_cl_vertex( const Point& position, IntervalProps& ival, double ipos) {
     Vertex  v = g.add_vertex(); 
     g[v].position = position;
     g[v].type = CL;
-    ival.intersections2.insert( VertexPair( v, ipos) ); // ?? this makes Interval depend on the WeaveGraph type
+    ival.intersections2.insert( VertexPair( v, ipos) );
     clVertexSet.insert(v);
     return v;
 }
@@ -159,8 +162,8 @@ void SimpleWeave::add_int_vertex(  const Point& v_position, // position of new v
                              Vertex& x_u, // the x-upper vertex
                              Vertex& y_l, // y-lower
                              Vertex& y_u, // y-upper
-                             Interval& x_int,  // the x-interval
-                             Interval& y_int ) // the y-interval
+                             IntervalProps& x_int,  // the x-interval
+                             IntervalProps& y_int ) // the y-interval
 {
     //std::cout << " add_int_vertex " << "\n";
     Vertex v = g.add_vertex(); //hedi::add_vertex( VertexProps( v_position, INT ), g);
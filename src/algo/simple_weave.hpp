@@ -37,9 +37,9 @@ class SimpleWeave : public Weave {
     protected:       
     
         /// add CL vertex to weave
-        /// sets position, type, and inserts the VertexPair into Interval::intersections
+        /// sets position, type, and inserts the VertexPair into IntervalProps::intersections2
         /// also adds the CL-vertex to clVertices, a list of cl-verts to be processed during face_traverse()
-        Vertex add_cl_vertex( const Point& position, Interval& interv, double ipos);
+        Vertex add_cl_vertex( const Point& position, IntervalProps& interv, double ipos);
         
         /// add INT vertex to weave
         /// the new vertex at v_position has neighbor vertices x_lower and x_upper in the x-direction on interval xi
@@ -50,11 +50,11 @@ class SimpleWeave : public Weave {
                                 Vertex& x_u, 
                                 Vertex& y_l,
                                 Vertex& y_u,
-                                Interval& xi,
-                                Interval& yi );
+                                IntervalProps& xi,
+                                IntervalProps& yi );
 
         /// given a vertex in the graph, find its upper and lower neighbor vertices
-        std::pair<Vertex,Vertex> find_neighbor_vertices( VertexPair v_pair, Interval& ival);
+        std::pair<Vertex,Vertex> find_neighbor_vertices( VertexPair v_pair, IntervalProps& ival);
 };
 
 } // end weave namespace
@@ -32,17 +32,17 @@ namespace weave
 {
 
 // given a VertexPair and an Interval, in the Interval find the Vertex above and below the given vertex
-std::pair<Vertex,Vertex> SmartWeave::find_neighbor_vertices( VertexPair v_pair, Interval& ival, bool above_equality ) { 
-    Interval::VertexPairIterator itr = ival.intersections2.lower_bound( v_pair ); // returns first that is not less than argument (equal or greater)
+std::pair<Vertex,Vertex> SmartWeave::find_neighbor_vertices( VertexPair v_pair, IntervalProps& ival, bool above_equality ) { 
+    VertexPairIterator itr = ival.intersections2.lower_bound( v_pair ); // returns first that is not less than argument (equal or greater)
     assert( itr != ival.intersections2.end() ); // we must find a lower_bound
-    Interval::VertexPairIterator v_above; 
+    VertexPairIterator v_above; 
     if ( above_equality ) 
         v_above = itr; // lower_bound returns one beyond the give key, i.e. what we want
     else {
         v_above = ++itr;
         --itr;
     }
-    Interval::VertexPairIterator v_below = --itr; // this is the vertex below the given vertex
+    VertexPairIterator v_below = --itr; // this is the vertex below the given vertex
     std::pair<Vertex,Vertex> out;
     out.first = v_above->first; // vertex above v (xu)
     out.second = v_below->first; // vertex below v (xl)
@@ -55,10 +55,11 @@ void SmartWeave::build() {
     std::cout << " SimpleWeave::build()... \n";
     
     // this adds all CL-vertices from x-intervals
-    // it also populates the xi.intersections_fibers set of intersecting y-fibers
+    // it also populates the IntervalProps::intersections_fibers set of intersecting y-fibers
     // also add the first-crossing vertex and the last-crossing vertex
     
     //std::cout << " build2() add_vertices_x() ... " << std::flush ;
+    initIntervalProps();
     add_vertices_x();
     //std::cout << " done.\n" << std::flush ;
     // the same for y-intervals, add all CL-points, and intersections to the set.
@@ -71,10 +72,11 @@ void SmartWeave::build() {
         std::vector<Interval>::iterator xi;
         for( xi = xf.ints.begin(); xi < xf.ints.end(); xi++ ) {
             std::set<std::vector<Fiber>::iterator>::const_iterator current, prev;
-            if( xi->intersections_fibers.size() > 1 ) {
-                current = xi->intersections_fibers.begin();
+            const IntervalProps& xp = xprops( xf, *xi );
+            if( xp.intersections_fibers.size() > 1 ) {
+                current = xp.intersections_fibers.begin();
                 prev = current++;
-                for( ; current != xi->intersections_fibers.end(); current++ ) {
+                for( ; current != xp.intersections_fibers.end(); current++ ) {
                     // for each x-interval, loop through the intersecting y-fibers
                     if( (*current - *prev) > 1 ) {
                         std::vector<Interval>::iterator yi = find_interval_crossing_x( xf, *(*prev + 1) );
@@ -100,11 +102,12 @@ void SmartWeave::build() {
         //int ny_int=0;
         for( yi = yf.ints.begin(); yi < yf.ints.end(); yi++ ) {
             //std::cout << "  interval nr: " << ny_int++ << " has yi->intersections_fibers.size()= " << yi->intersections_fibers.size() << "\n" << std::flush;
-            std::set<std::vector<Fiber>::iterator>::iterator current, prev;
-            if( yi->intersections_fibers.size() > 1 ) {
-                current = yi->intersections_fibers.begin();
+            std::set<std::vector<Fiber>::iterator>::const_iterator current, prev;
+            const IntervalProps& yp = yprops( yf, *yi );
+            if( yp.intersections_fibers.size() > 1 ) {
+                current = yp.intersections_fibers.begin();
                 prev = current++;
-                for( ; current != yi->intersections_fibers.end(); current++ ) {
+                for( ; current != yp.intersections_fibers.end(); current++ ) {
                     if( (*current - *prev) > 1 ) {
                         std::vector<Interval>::iterator xi = find_interval_crossing_y( *(*prev + 1), yf );
                         add_vertex( *(*prev + 1), yf, xi , yi, FULLINT );
@@ -126,11 +129,11 @@ void SmartWeave::build() {
 }
 
 // add a new CL-vertex to Weave, also adding it to the interval intersection-set, and to clVertices
-Vertex SmartWeave::add_cl_vertex( const Point& position, Interval& ival, double ipos) {
+Vertex SmartWeave::add_cl_vertex( const Point& position, IntervalProps& ival, double ipos) {
     Vertex  v = g.add_vertex(); 
     g[v].position = position;
     g[v].type = CL;
-    ival.intersections2.insert( VertexPair( v, ipos) ); // ?? this makes Interval depend on the WeaveGraph type
+    ival.intersections2.insert( VertexPair( v, ipos) );
     clVertexSet.insert(v);
     return v;
 }
@@ -151,14 +154,15 @@ void SmartWeave::add_vertices_x() {
             }
 
             if( yf < yfibers.end() ) {
+                IntervalProps& xp = xprops( *xf, *xi );
                 Point lower( xf->point( xi->lower ) );
-                add_cl_vertex( lower, *xi, lower.x );
+                add_cl_vertex( lower, xp, lower.x );
                 Point upper( xf->point( xi->upper ) );
-                add_cl_vertex( upper, *xi, upper.x );
+                add_cl_vertex( upper, xp, upper.x );
 
                 add_vertex( *xf, *yf, xi, yi, INT ); // the first crossing vertex
-                xi->intersections_fibers.insert( yf );
-                yi->intersections_fibers.insert( xf );
+                xp.intersections_fibers.insert( yf );
+                yprops( *yf, *yi ).intersections_fibers.insert( xf );
 
                 is_crossing = crossing_x( *yf, yi, *xi, *xf );
                 while( (yf<yfibers.end()) && is_crossing ) {// last crossing 
@@ -166,8 +170,8 @@ void SmartWeave::add_vertices_x() {
                     if( yf<yfibers.end() ) is_crossing = crossing_x( *yf, yi, *xi, *xf );
                 }
                 add_vertex( *xf, *(--yf), xi, yi, INT ); // the last crossing vertex
-                xi->intersections_fibers.insert( yf );
-                yi->intersections_fibers.insert( xf );
+                xp.intersections_fibers.insert( yf );
+                yprops( *yf, *yi ).intersections_fibers.insert( xf );
             }
         }// end foreach x-interval
     }// end foreach x-fiber
@@ -189,14 +193,15 @@ void SmartWeave::add_vertices_y() {
             }
 
             if( xf < xfibers.end() ) {
+                IntervalProps& yp = yprops( *yf, *yi );
                 Point lower( yf->point( yi->lower ) );
-                add_cl_vertex( lower, *yi, lower.y );
+                add_cl_vertex( lower, yp, lower.y );
                 Point upper( yf->point( yi->upper ) );
-                add_cl_vertex( upper, *yi, upper.y );
+                add_cl_vertex( upper, yp, upper.y );
 
                 if( add_vertex( *xf, *yf, xi, yi, INT ) ) { // add_vertex returns false if vertex already exists
-                    xi->intersections_fibers.insert( yf );
-                    yi->intersections_fibers.insert( xf );
+                    xprops( *xf, *xi ).intersections_fibers.insert( yf );
+                    yp.intersections_fibers.insert( xf );
                 }
 
                 bool is_crossing = crossing_y( *xf, xi, *yi, *yf );
@@ -205,8 +210,8 @@ void SmartWeave::add_vertices_y() {
                     if( xf<xfibers.end() ) is_crossing = crossing_y( *xf, xi, *yi, *yf );
                 }
                 if( add_vertex( *(--xf), *yf, xi, yi, INT ) ) {
-                    xi->intersections_fibers.insert( yf );
-                    yi->intersections_fibers.insert( xf );
+                    xprops( *xf, *xi ).intersections_fibers.insert( yf );
+                    yp.intersections_fibers.insert( xf );
                 }
             }
         }// end foreach x-interval
@@ -276,7 +281,9 @@ bool SmartWeave::add_vertex( Fiber& xf, Fiber& yf,
                         std::vector<Interval>::iterator yi,
                         enum VertexType type ) {
     //test if vertex exists
-    BOOST_FOREACH( std::vector<Fiber>::iterator it_xf, yi->intersections_fibers ) {
+    IntervalProps& xp = xprops( xf, *xi );
+    IntervalProps& yp = yprops( yf, *yi );
+    BOOST_FOREACH( std::vector<Fiber>::iterator it_xf, yp.intersections_fibers ) {
         if( *it_xf == xf )
             return false;
     }
@@ -284,10 +291,10 @@ bool SmartWeave::add_vertex( Fiber& xf, Fiber& yf,
     Vertex v =g.add_vertex(); 
     g[v].position = v_position;
     g[v].type = type;
-    g[v].xi= xi;
-    g[v].yi= yi;
-    xi->intersections2.insert( VertexPair( v, v_position.x ) );
-    yi->intersections2.insert( VertexPair( v, v_position.y ) );
+    g[v].xi= &xp;
+    g[v].yi= &yp;
+    xp.intersections2.insert( VertexPair( v, v_position.x ) );
+    yp.intersections2.insert( VertexPair( v, v_position.y ) );
     return true;
 }
 
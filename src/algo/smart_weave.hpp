@@ -41,14 +41,14 @@ class SmartWeave : public Weave {
         bool crossing_y( Fiber& xf, std::vector<Interval>::iterator& xi, Interval& yi, Fiber& yf );
         std::vector<Interval>::iterator find_interval_crossing_x( Fiber& xf, Fiber& yf );
         std::vector<Interval>::iterator find_interval_crossing_y( Fiber& xf, Fiber& yf );
-        Vertex add_cl_vertex( const Point& position, Interval& ival, double ipos);
+        Vertex add_cl_vertex( const Point& position, IntervalProps& ival, double ipos);
         bool add_vertex(    Fiber& xf, 
                             Fiber& yf,
                             std::vector<Interval>::iterator xi, 
                             std::vector<Interval>::iterator yi,
                             enum VertexType type );
         void add_all_edges();
-        std::pair<Vertex,Vertex> find_neighbor_vertices( VertexPair v_pair, Interval& ival, bool above_equality );
+        std::pair<Vertex,Vertex> find_neighbor_vertices( VertexPair v_pair, IntervalProps& ival, bool above_equality );
 };
 
 } // end weave namespace
@@ -19,15 +19,15 @@
  *  along with this program. If not, see <http://www.gnu.org/licenses/>.
 */
 
-#include <boost/foreach.hpp> 
+#include <list>
+#include <memory>
 
-#ifdef _OPENMP
-    #include <omp.h>
-#endif
+#include <boost/foreach.hpp> 
 
 #include "millingcutter.hpp"
 #include "point.hpp"
 #include "triangle.hpp"
+#include "stlsurf.hpp"
 #include "waterline.hpp"
 #include "batchpushcutter.hpp"
 // #include "weave.hpp"
@@ -45,13 +45,6 @@ Waterline::Waterline() {
     subOp.push_back( new BatchPushCutter() );
     subOp[0]->setXDirection();
     subOp[1]->setYDirection();
-    nthreads=1;
-#ifdef _OPENMP
-    nthreads = omp_get_num_procs(); 
-    //omp_set_dynamic(0);
-    omp_set_nested(1);
-#endif
-
 }
 
 Waterline::~Waterline() {
@@ -66,8 +59,7 @@ Waterline::~Waterline() {
 // pass the fibers to weave, and process the weave to get waterline-loops
 void Waterline::run2() {
     init_fibers();
-    subOp[0]->run(); // these two are independent, so could/should run in parallel
-    subOp[1]->run();
+    pushCutter();
     
     xfibers = *( subOp[0]->getFibers() );
     yfibers = *( subOp[1]->getFibers() );
@@ -77,8 +69,7 @@ void Waterline::run2() {
 
 void Waterline::run() {
     init_fibers();
-    subOp[0]->run(); // these two are independent, so could/should run in parallel
-    subOp[1]->run();
+    pushCutter();
     
     xfibers = *( subOp[0]->getFibers() );
     yfibers = *( subOp[1]->getFibers() );
@@ -87,6 +78,15 @@ void Waterline::run() {
 }
 
 
+// the x- and y-fibers are independent, so they are pushed as one batch, and a thread
+// that runs out of x-fibers goes on with y-fibers
+void Waterline::pushCutter() {
+    std::vector<BatchPushCutter*> ops;
+    ops.push_back( static_cast<BatchPushCutter*>( subOp[0] ) );
+    ops.push_back( static_cast<BatchPushCutter*>( subOp[1] ) );
+    BatchPushCutter::runAll( getExecutor(), ops );
+}
+
 void Waterline::reset() {
     xfibers.clear();
     yfibers.clear();
@@ -162,6 +162,24 @@ void Waterline::init_fibers() {
         Fiber f = Fiber( p1 , p2 );
         subOp[1]->appendFiber( f );
     }
+    // the cutter spans [zh, zh + length], triangles entirely above or below can not be touched.
+    // When these are less than half of the surface, both directions search only these, each in
+    // an index of its own over pointers into the surface. Otherwise the cached indexes over the
+    // whole surface are about as fast, and are shared with the other levels.
+    static_cast<BatchPushCutter*>( subOp[0] )->clearTriangles();
+    static_cast<BatchPushCutter*>( subOp[1] )->clearTriangles();
+    std::shared_ptr<const TriangleStore> store = surf->getStore();
+    std::vector<unsigned int> ids;
+    store->zSlab( zh, zh + cutter->getLength(), ids );
+    if ( ids.empty() || 2*ids.size() > store->size() )
+        return;
+    std::shared_ptr< std::vector<const Triangle*> > slab = std::make_shared< std::vector<const Triangle*> >();
+    slab->reserve( ids.size() );
+    BOOST_FOREACH( unsigned int i, ids ) {
+        slab->push_back( &store->triangle(i) );
+    }
+    static_cast<BatchPushCutter*>( subOp[0] )->setTriangles( slab );
+    static_cast<BatchPushCutter*>( subOp[1] )->setTriangles( slab );
 }
 
 // return a double-vector [ start , ... , end ] with N elements
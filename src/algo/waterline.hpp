@@ -42,6 +42,7 @@ namespace ocl
 /// from an STL-model. Waterline uses two BatchPushCutter sub-operations to find out where the CL-points are located
 /// and a Weave to split and order the CL-points correctly into loops.
 class Waterline : public Operation {
+    friend class MultiWaterline;
     public:
         /// create an empty Waterline object
         Waterline(); 
@@ -63,11 +64,13 @@ class Waterline : public Operation {
         void reset();
         
     protected:
+        /// run both BatchPushCutter sub-operations, in parallel
+        void pushCutter();
         /// from xfibers and yfibers, build the weave, run face-traverse, and write toolpaths to loops
         void weave_process();
         void weave_process2();
         
-        /// initialization of fibers
+        /// initialization of fibers, and of the triangles near zh that the fibers are pushed against
         void init_fibers();
         /// x and y-coordinates for fiber generation
         std::vector<double> generate_range( double start, double end, int N) const;
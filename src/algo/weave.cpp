@@ -32,7 +32,7 @@ namespace ocl
 namespace weave
 {
 
-int VertexProps::count = 0;
+std::atomic<int> VertexProps::count(0);
 
 void Weave::addFiber(Fiber& f) {
     if ( f.dir.xParallel() && !f.empty() ) {
@@ -44,6 +44,20 @@ void Weave::addFiber(Fiber& f) {
     }
 }
 
+void Weave::initIntervalProps() {
+    firstProps.clear();
+    unsigned int n = 0;
+    BOOST_FOREACH( const Fiber& xf, xfibers ) {
+        firstProps.push_back(n);
+        n += xf.ints.size();
+    }
+    BOOST_FOREACH( const Fiber& yf, yfibers ) {
+        firstProps.push_back(n);
+        n += yf.ints.size();
+    }
+    intervalProps.assign( n, IntervalProps() );
+}
+
 // traverse the graph putting loops of vertices into the loops variable
 // this figure illustrates next-pointers: http://www.anderswallin.net/wp-content/uploads/2011/05/weave2_zoom.png
 void Weave::face_traverse() { 
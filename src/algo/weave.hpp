@@ -52,11 +52,26 @@ class Weave {
         void printGraph() ;
         
     protected:       
+        /// create the IntervalProps of all intervals, called by build() before xprops() or yprops()
+        void initIntervalProps();
+        /// the IntervalProps of interval xi of x-fiber xf
+        IntervalProps& xprops(const Fiber& xf, const Interval& xi) {
+            return intervalProps[ firstProps[ &xf - &xfibers[0] ] + ( &xi - &xf.ints[0] ) ];
+        }
+        /// the IntervalProps of interval yi of y-fiber yf
+        IntervalProps& yprops(const Fiber& yf, const Interval& yi) {
+            return intervalProps[ firstProps[ xfibers.size() + ( &yf - &yfibers[0] ) ] + ( &yi - &yf.ints[0] ) ];
+        }
+        
         WeaveGraph g;                             ///< the weave-graph
         std::vector< std::vector<Vertex> > loops; ///< output: list of loops in this weave
         std::vector<Fiber> xfibers;               ///< the X-fibers
         std::vector<Fiber> yfibers;               ///< the Y-fibers
         std::set<Vertex> clVertexSet;             ///< set of CL-points
+        /// the weave bookkeeping for the intervals of the x-fibers, followed by the y-fibers
+        std::vector<IntervalProps> intervalProps;
+        /// index in intervalProps of the first interval of each x-fiber, followed by each y-fiber
+        std::vector<unsigned int> firstProps;
 };
 
 } // end weave namespace
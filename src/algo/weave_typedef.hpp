@@ -21,8 +21,12 @@
 #ifndef WEAVE_TYPEDEF_H
 #define WEAVE_TYPEDEF_H
 
+#include <atomic>
+#include <set>
+#include <vector>
+
 #include "halfedgediagram.hpp"
-#include "interval.hpp"
+#include "fiber.hpp"
 
 namespace ocl {
 
@@ -35,22 +39,24 @@ typedef boost::adjacency_list_traits<boost::listS,
                                      boost::bidirectionalS, 
                                      boost::listS >::edge_descriptor Edge;
 
+struct IntervalProps;
+
 /// vertex type: CL-point, internal point, adjacent point
 enum VertexType {CL, CL_DONE, ADJ, TWOADJ, INT, FULLINT};
 
 /// vertex properties
 struct VertexProps {
-    VertexProps() {
+    VertexProps() : xi( NULL ), yi( NULL ) {
         init();
     }
     /// construct vertex at position p with type t
-    VertexProps( Point p, VertexType t) {
+    VertexProps( Point p, VertexType t) : xi( NULL ), yi( NULL ) {
         position=p;
         type=t;
         init();
     }
     /// construct vertex at position p with type t
-    VertexProps( Point p, VertexType t, std::vector<Interval>::iterator x, std::vector<Interval>::iterator y )
+    VertexProps( Point p, VertexType t, IntervalProps* x, IntervalProps* y )
     : xi( x ), yi( y ) {
         position=p;
         type=t;
@@ -58,8 +64,7 @@ struct VertexProps {
     }
     
     void init() {
-        index = count;
-        count++;
+        index = count++;
     }
     VertexType type;
 // HE data
@@ -67,13 +72,13 @@ struct VertexProps {
     Point position;
     /// index of vertex
     int index;
-    /// global vertex count
-    static int count;
+    /// global vertex count, atomic since weaves of different levels are built at the same time
+    static std::atomic<int> count;
     
-    // x interval
-    std::vector<Interval>::iterator xi;
-    // y interval
-    std::vector<Interval>::iterator yi;
+    /// the x interval
+    IntervalProps* xi;
+    /// the y interval
+    IntervalProps* yi;
     
 };
 
@@ -142,6 +147,17 @@ typedef std::set< VertexPair, VertexPairCompare > VertexIntersectionSet;
 
 typedef VertexIntersectionSet::iterator VertexPairIterator;    
 
+/// the weave bookkeeping for one Interval of a Fiber, see Weave::xprops() and Weave::yprops()
+struct IntervalProps {
+    IntervalProps() : in_weave(false) {}
+    /// flag for use by SimpleWeave::build()
+    bool in_weave;
+    /// the fibers that cross the interval, for use by SmartWeave::build()
+    std::set<std::vector<Fiber>::iterator> intersections_fibers;
+    /// the vertices on the interval, in order along the fiber
+    VertexIntersectionSet intersections2;
+};
+
 } // end weave namespace
 
 } // end ocl namespace
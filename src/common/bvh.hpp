@@ -0,0 +1,398 @@
+/*  $Id$
+ *
+ *  Copyright (c) 2010-2011 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *
+ *  This file is part of OpenCAMlib
+ *  (see https://github.com/aewallin/opencamlib).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BVH_H
+#define BVH_H
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <list>
+#include <vector>
+#include <algorithm>
+#include <cassert>
+
+#include <boost/foreach.hpp>
+
+#include "spatialindex.hpp"
+#include "bbox.hpp"
+#include "numeric.hpp"
+
+namespace ocl
+{
+
+/// \brief node of a BVH, with up to four children.
+///
+/// The bounding boxes of the children are stored in the node, as
+/// structure-of-arrays over the two axes of the search plane, so that a
+/// search tests all children of a node without visiting them.
+struct BVHNode {
+    /// minimum of child c along search-plane axis a is lo[a][c]
+    double lo[2][4];
+    /// maximum of child c along search-plane axis a is hi[a][c]
+    double hi[2][4];
+    /// node index of an internal child, or the first index-array entry of a leaf child
+    unsigned int child[4];
+    /// number of objects in a leaf child, zero for an internal child
+    unsigned int count[4];
+    /// number of children in use
+    unsigned int n;
+};
+
+/// \brief a 4-wide bounding volume hierarchy
+///
+/// Each node bounds its objects with a box in the search plane set by
+/// setXYDimensions()/setYZDimensions()/setXZDimensions(). Unlike the kd-trees,
+/// an object is never split between nodes, and a search only visits nodes whose
+/// box overlaps the query, so long thin triangles do not slow down searches.
+///
+/// build() splits the objects in two by a binned surface-area-heuristic on
+/// the object centers, and a node is made from up to four of these binary splits.
+/// The tree stores pointers into the list given to build(), which must outlive the tree.
+template <class BBObj>
+class BVH : public SpatialIndex<BBObj> {
+    public:
+        BVH() {}
+        virtual ~BVH() {}
+        /// build the BVH based on a list of input objects
+        void build(const std::list<BBObj>& list) {
+            objs.clear();
+            objs.reserve( list.size() );
+            BOOST_FOREACH(const BBObj& o, list) {
+                objs.push_back( &o );
+            }
+            build_objs();
+        }
+        /// build the BVH based on pointers to input objects
+        void build(const std::vector<const BBObj*>& o) {
+            objs = o;
+            build_objs();
+        }
+        /// search for overlap with input Bbox bb, return found objects
+        std::list<BBObj>* search( const Bbox& bb ) const {
+            std::vector<const BBObj*> found;
+            search( bb, found );
+            std::list<BBObj>* tris = new std::list<BBObj>();
+            BOOST_FOREACH(const BBObj* o, found) {
+                tris->push_back( *o );
+            }
+            return tris;
+        }
+        /// search for overlap with input Bbox bb, place pointers to found objects in out
+        void search( const Bbox& bb, std::vector<const BBObj*>& out ) const {
+            assert( !this->dimensions.empty() );
+            out.clear();
+            if ( nodes.empty() )
+                return;
+            double qlo[2] = { bb[2*axis[0]], bb[2*axis[1]] };
+            double qhi[2] = { bb[2*axis[0]+1], bb[2*axis[1]+1] };
+            search_node( out, qlo, qhi, 0 );
+        }
+        /// search for overlap with input Bbox bb, place list positions of found objects in out
+        void search( const Bbox& bb, std::vector<unsigned int>& out ) const {
+            assert( !this->dimensions.empty() );
+            out.clear();
+            if ( nodes.empty() )
+                return;
+            double qlo[2] = { bb[2*axis[0]], bb[2*axis[1]] };
+            double qhi[2] = { bb[2*axis[0]+1], bb[2*axis[1]+1] };
+            search_node( out, qlo, qhi, 0 );
+        }
+        /// return the number of nodes in the tree
+        unsigned int size() const { return nodes.size(); }
+        /// string repr
+        std::string str() const {
+            unsigned int nleaves = 0;
+            BOOST_FOREACH(const BVHNode& node, nodes) {
+                for (unsigned int c=0; c<node.n; ++c)
+                    if ( node.count[c] )
+                        ++nleaves;
+            }
+            std::ostringstream o;
+            o << "BVH N=" << objs.size() << " nodes=" << nodes.size() << " leaves=" << nleaves;
+            return o.str();
+        }
+
+    protected:
+        /// build the BVH over objs, set by build()
+        void build_objs() {
+            nodes.clear();
+            index.clear();
+            assert( this->dimensions.size() == 4 );
+            axis[0] = this->dimensions[0]/2;
+            axis[1] = this->dimensions[2]/2;
+            if ( objs.empty() ) {
+                std::cout << "ERROR: BVH::build() called with list.size()==0 ! \n";
+                assert(0);
+                return;
+            }
+            index.resize( objs.size() );
+            for (unsigned int n=0; n<index.size(); ++n)
+                index[n] = n;
+            nodes.reserve( objs.size()/2 + 1 );
+            Range r( 0, index.size() );
+            calc_bounds( r );
+            build_node( r );
+        }
+        /// number of bins per axis used by the build
+        static const int NBINS = 16;
+
+        /// a range [first, last) of the index array, and its bounds in the search plane
+        struct Range {
+            Range() : first(0), last(0) {}
+            Range(unsigned int f, unsigned int l) : first(f), last(l) {}
+            unsigned int size() const { return last-first; }
+            unsigned int first;
+            unsigned int last;
+            double lo[2];
+            double hi[2];
+        };
+
+        /// predicate for std::partition, true for objects whose center falls in a bin below splitbin
+        class BinPredicate {
+            public:
+                BinPredicate(const BVH& t, int a, double l, double s, int b)
+                    : tree(t), ax(a), lo(l), scale(s), splitbin(b) {}
+                bool operator()(unsigned int i) const { return tree.bin( i, ax, lo, scale ) < splitbin; }
+            private:
+                const BVH& tree;
+                int ax;
+                double lo;
+                double scale;
+                int splitbin;
+        };
+
+        /// the center of object i along search-plane axis a
+        double center(unsigned int i, int a) const {
+            const Bbox& bb = objs[i]->bb;
+            return 0.5*( bb[2*axis[a]] + bb[2*axis[a]+1] );
+        }
+
+        /// the bin of object i along search-plane axis a
+        int bin(unsigned int i, int a, double lo, double scale) const {
+            int b = (int)( (center(i, a)-lo)*scale );
+            return std::min( std::max(b, 0), NBINS-1 );
+        }
+
+        /// calculate the bounds of r
+        void calc_bounds(Range& r) const {
+            for (int a=0;a<2;++a) {
+                r.lo[a] = objs[ index[r.first] ]->bb[ 2*axis[a] ];
+                r.hi[a] = objs[ index[r.first] ]->bb[ 2*axis[a]+1 ];
+            }
+            for (unsigned int i=r.first+1; i<r.last; ++i) {
+                const Bbox& bb = objs[ index[i] ]->bb;
+                for (int a=0;a<2;++a) {
+                    r.lo[a] = std::min( r.lo[a], bb[ 2*axis[a] ] );
+                    r.hi[a] = std::max( r.hi[a], bb[ 2*axis[a]+1 ] );
+                }
+            }
+        }
+
+        /// half the perimeter of a box in the search plane, the cost measure of the build
+        static double half_perimeter(const double* lo, const double* hi) {
+            return (hi[0]-lo[0]) + (hi[1]-lo[1]);
+        }
+
+        /// split r in two non-empty ranges a and b. r must hold at least two objects.
+        /// r is a copy, so a may refer to the range being split.
+        void split_range(const Range r, Range& a, Range& b) {
+            // bounds of the object centers
+            double clo[2];
+            double chi[2];
+            for (int ax=0;ax<2;++ax)
+                clo[ax] = chi[ax] = center( index[r.first], ax );
+            for (unsigned int i=r.first+1; i<r.last; ++i) {
+                for (int ax=0;ax<2;++ax) {
+                    double c = center( index[i], ax );
+                    clo[ax] = std::min( clo[ax], c );
+                    chi[ax] = std::max( chi[ax], c );
+                }
+            }
+            unsigned int split = r.first + r.size()/2; // split by count if all centers coincide
+            int bestax = -1;
+            int bestbin = 0;
+            double bestcost = 0;
+            for (int ax=0;ax<2;++ax) {
+                if ( isZero_tol( chi[ax]-clo[ax] ) )
+                    continue;
+                double scale = NBINS/(chi[ax]-clo[ax]);
+                unsigned int count[NBINS] = {0};
+                double blo[NBINS][2];
+                double bhi[NBINS][2];
+                for (unsigned int i=r.first; i<r.last; ++i) {
+                    int k = bin( index[i], ax, clo[ax], scale );
+                    const Bbox& bb = objs[ index[i] ]->bb;
+                    for (int d=0;d<2;++d) {
+                        double l = bb[ 2*axis[d] ];
+                        double h = bb[ 2*axis[d]+1 ];
+                        if ( count[k] == 0 ) {
+                            blo[k][d] = l;
+                            bhi[k][d] = h;
+                        } else {
+                            blo[k][d] = std::min( blo[k][d], l );
+                            bhi[k][d] = std::max( bhi[k][d], h );
+                        }
+                    }
+                    ++count[k];
+                }
+                // sweep from the right to get the cost of the objects above each split
+                double rightcost[NBINS];
+                double lo[2];
+                double hi[2];
+                unsigned int n = 0;
+                for (int k=NBINS-1; k>0; --k) {
+                    merge_bin( count[k], blo[k], bhi[k], n, lo, hi );
+                    rightcost[k] = n ? n*half_perimeter(lo, hi) : 0;
+                }
+                n = 0;
+                for (int k=1; k<NBINS; ++k) {
+                    merge_bin( count[k-1], blo[k-1], bhi[k-1], n, lo, hi );
+                    if ( n == 0 || n == r.size() )
+                        continue;
+                    double cost = n*half_perimeter(lo, hi) + rightcost[k];
+                    if ( bestax < 0 || cost < bestcost ) {
+                        bestax = ax;
+                        bestbin = k;
+                        bestcost = cost;
+                    }
+                }
+            }
+            if ( bestax >= 0 ) {
+                double scale = NBINS/(chi[bestax]-clo[bestax]);
+                unsigned int* begin = &index[0];
+                unsigned int* mid = std::partition( begin+r.first, begin+r.last,
+                                                    BinPredicate(*this, bestax, clo[bestax], scale, bestbin) );
+                split = mid - begin;
+            }
+            assert( split > r.first && split < r.last );
+            a = Range( r.first, split );
+            b = Range( split, r.last );
+            calc_bounds( a );
+            calc_bounds( b );
+        }
+
+        /// grow the box lo/hi of n objects with a bin of count objects
+        static void merge_bin(unsigned int count, const double* blo, const double* bhi,
+                              unsigned int& n, double* lo, double* hi) {
+            if ( count == 0 )
+                return;
+            for (int d=0;d<2;++d) {
+                lo[d] = n ? std::min( lo[d], blo[d] ) : blo[d];
+                hi[d] = n ? std::max( hi[d], bhi[d] ) : bhi[d];
+            }
+            n += count;
+        }
+
+        /// build a node for the objects in r, and return its index
+        unsigned int build_node(const Range& r) {
+            unsigned int n = nodes.size();
+            nodes.push_back( BVHNode() );
+            // split r up to three times, each time splitting the largest child
+            Range c[4];
+            unsigned int nc = 1;
+            c[0] = r;
+            while ( nc < 4 ) {
+                int largest = -1;
+                for (unsigned int i=0; i<nc; ++i)
+                    if ( c[i].size() > this->bucketSize && c[i].size() > 1 &&
+                         ( largest < 0 || c[i].size() > c[largest].size() ) )
+                        largest = i;
+                if ( largest < 0 )
+                    break;
+                split_range( c[largest], c[largest], c[nc] );
+                ++nc;
+            }
+            nodes[n].n = nc;
+            for (unsigned int i=0; i<4; ++i) {
+                if ( i < nc ) {
+                    for (int a=0;a<2;++a) {
+                        nodes[n].lo[a][i] = c[i].lo[a];
+                        nodes[n].hi[a][i] = c[i].hi[a];
+                    }
+                } else { // an empty box, never overlaps a query
+                    for (int a=0;a<2;++a) {
+                        nodes[n].lo[a][i] = 1;
+                        nodes[n].hi[a][i] = -1;
+                    }
+                    nodes[n].child[i] = 0;
+                    nodes[n].count[i] = 0;
+                }
+            }
+            for (unsigned int i=0; i<nc; ++i) {
+                if ( c[i].size() <= this->bucketSize || c[i].size() == 1 ) {
+                    nodes[n].child[i] = c[i].first;
+                    nodes[n].count[i] = c[i].size();
+                } else {
+                    unsigned int child = build_node( c[i] ); // may reallocate nodes
+                    nodes[n].child[i] = child;
+                    nodes[n].count[i] = 0;
+                }
+            }
+            return n;
+        }
+
+        /// search node n for overlap with the query box qlo/qhi in the search plane
+        void search_node( std::vector<const BBObj*>& out, const double* qlo, const double* qhi,
+                          unsigned int n ) const {
+            const BVHNode& node = nodes[n];
+            for (unsigned int c=0; c<node.n; ++c) {
+                if ( node.lo[0][c] > qhi[0] || node.hi[0][c] < qlo[0] ||
+                     node.lo[1][c] > qhi[1] || node.hi[1][c] < qlo[1] )
+                    continue;
+                if ( node.count[c] ) {
+                    for (unsigned int i=node.child[c]; i<node.child[c]+node.count[c]; ++i)
+                        out.push_back( objs[ index[i] ] );
+                } else {
+                    search_node( out, qlo, qhi, node.child[c] );
+                }
+            }
+        }
+
+        /// as search_node() above, but place the list positions of the found objects in out
+        void search_node( std::vector<unsigned int>& out, const double* qlo, const double* qhi,
+                          unsigned int n ) const {
+            const BVHNode& node = nodes[n];
+            for (unsigned int c=0; c<node.n; ++c) {
+                if ( node.lo[0][c] > qhi[0] || node.hi[0][c] < qlo[0] ||
+                     node.lo[1][c] > qhi[1] || node.hi[1][c] < qlo[1] )
+                    continue;
+                if ( node.count[c] )
+                    out.insert( out.end(), index.begin()+node.child[c], index.begin()+node.child[c]+node.count[c] );
+                else
+                    search_node( out, qlo, qhi, node.child[c] );
+            }
+        }
+
+    // DATA
+        /// the objects, in the order they were given to build()
+        std::vector<const BBObj*> objs;
+        /// permuted indices into objs. Each leaf is a contiguous range of this array.
+        std::vector<unsigned int> index;
+        /// the nodes of the tree, nodes[0] is the root
+        std::vector<BVHNode> nodes;
+        /// the two axes (0=x, 1=y, 2=z) of the search plane
+        int axis[2];
+};
+
+} // end ocl namespace
+#endif
+// end file bvh.hpp
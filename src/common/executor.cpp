@@ -0,0 +1,175 @@
+/*  $Id$
+ * 
+ *  Copyright (c) 2010 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *  
+ *  This file is part of OpenCAMlib 
+ *  (see https://github.com/aewallin/opencamlib).
+ *  
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <map>
+#include <system_error>
+
+#include "executor.hpp"
+
+namespace ocl
+{
+
+/// one call to ThreadPool::run()
+struct ThreadPool::Batch {
+    /// the tasks
+    const std::function<void (unsigned int)>* task;
+    /// number of tasks
+    unsigned int n;
+    /// the next task to start
+    unsigned int next;
+    /// number of finished tasks
+    unsigned int finished;
+};
+
+ThreadPool::ThreadPool(unsigned int n) : stopping(false) {
+    for (unsigned int m=1; m<n; ++m) {
+        try {
+            workers.push_back( std::thread( &ThreadPool::loop, this ) );
+        } catch (const std::system_error&) {
+            break; // no threads on this platform, or out of them. Run with what we have.
+        }
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (unsigned int m=0; m<workers.size(); ++m)
+        workers[m].join();
+}
+
+void ThreadPool::work(Batch& b, std::unique_lock<std::mutex>& lock) {
+    while ( b.next < b.n ) {
+        unsigned int k = b.next++;
+        lock.unlock();
+        (*b.task)(k);
+        lock.lock();
+        if ( ++b.finished == b.n )
+            done.notify_all();
+    }
+}
+
+void ThreadPool::loop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        while ( !stopping && batches.empty() )
+            wake.wait(lock);
+        if ( stopping )
+            return;
+        std::shared_ptr<Batch> b = batches.front();
+        batches.pop_front(); // all tasks of b are started by the threads that hold b
+        if ( b->next+1 < b->n )
+            batches.push_front(b);
+        work(*b, lock);
+    }
+}
+
+void ThreadPool::run(unsigned int n, const std::function<void (unsigned int)>& task) {
+    if ( n == 0 )
+        return;
+    if ( workers.empty() || n == 1 ) {
+        for (unsigned int k=0; k<n; ++k)
+            task(k);
+        return;
+    }
+    std::shared_ptr<Batch> b( new Batch() );
+    b->task = &task;
+    b->n = n;
+    b->next = 0;
+    b->finished = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    batches.push_back(b);
+    wake.notify_all();
+    work(*b, lock);
+    batches.erase( std::remove( batches.begin(), batches.end(), b ), batches.end() );
+    while ( b->finished < b->n )
+        done.wait(lock);
+}
+
+std::shared_ptr<Executor> ThreadPool::shared(unsigned int n) {
+    static std::mutex m;
+    static std::map< unsigned int, std::weak_ptr<Executor> > pools;
+    n = std::max(n, 1u);
+    std::lock_guard<std::mutex> lock(m);
+    std::shared_ptr<Executor> pool = pools[n].lock();
+    if ( !pool ) {
+        pool.reset( new ThreadPool(n) );
+        pools[n] = pool;
+    }
+    return pool;
+}
+
+unsigned int ThreadPool::hardwareThreads() {
+    return std::max( std::thread::hardware_concurrency(), 1u );
+}
+
+/// a part of the parallel_for() range, [begin, end)
+struct RangePart {
+    std::mutex mutex;
+    unsigned int begin;
+    unsigned int end;
+};
+
+void parallel_for(Executor& ex, unsigned int n, unsigned int grain,
+                  const std::function<void (unsigned int, unsigned int, unsigned int)>& body) {
+    if ( n == 0 )
+        return;
+    grain = std::max(grain, 1u);
+    const unsigned int P = std::min( ex.concurrency(), (n+grain-1)/grain );
+    std::unique_ptr<RangePart[]> parts( new RangePart[P] );
+    for (unsigned int p=0; p<P; ++p) {
+        parts[p].begin = (unsigned long long)n*p/P;
+        parts[p].end = (unsigned long long)n*(p+1)/P;
+    }
+    ex.run( P, [&](unsigned int slot) {
+        for (;;) {
+            unsigned int b = 0, e = 0;
+            { // own part, from the front
+                RangePart& own = parts[slot];
+                std::lock_guard<std::mutex> lock( own.mutex );
+                if ( own.begin < own.end ) {
+                    b = own.begin;
+                    e = std::min( own.end, b+grain );
+                    own.begin = e;
+                }
+            }
+            for (unsigned int q=1; q<P && b==e; ++q) { // steal from the back of the others
+                RangePart& other = parts[ (slot+q) % P ];
+                std::lock_guard<std::mutex> lock( other.mutex );
+                if ( other.begin < other.end ) {
+                    e = other.end;
+                    b = ( e-other.begin > grain ) ? e-grain : other.begin;
+                    other.end = b;
+                }
+            }
+            if ( b == e )
+                return;
+            body(b, e, slot);
+        }
+    } );
+}
+
+} // end ocl namespace
+// end file executor.cpp
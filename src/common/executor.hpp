@@ -0,0 +1,104 @@
+/*  $Id$
+ *
+ *  Copyright (c) 2010-2011 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *
+ *  This file is part of OpenCAMlib
+ *  (see https://github.com/aewallin/opencamlib).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ocl
+{
+
+/// \brief runs the parallel work of Operations
+///
+/// An Executor runs a batch of tasks and returns when all of them are done.
+/// The Operations split their loops with parallel_for(), on top of Executor::run().
+/// A host application with its own thread pool can implement this interface, and give it to
+/// all Operations with Operation::setExecutor(), so that the library never
+/// starts more threads than the host wants.
+class Executor {
+    public:
+        virtual ~Executor() {}
+        /// the number of tasks that may run at the same time, including the calling thread
+        virtual unsigned int concurrency() const = 0;
+        /// run task(0) to task(n-1), some of them at the same time, and return when all are done.
+        /// Must work when called from inside a task. It is correct, though slow, to run them one by one.
+        virtual void run(unsigned int n, const std::function<void (unsigned int)>& task) = 0;
+};
+
+/// \brief the default Executor, a fixed pool of worker threads
+///
+/// The calling thread works on its own batch too, so a pool of concurrency() n has n-1 workers,
+/// and a call to run() from inside a task can not dead-lock.
+class ThreadPool : public Executor {
+    public:
+        /// a pool that runs up to n tasks at the same time
+        explicit ThreadPool(unsigned int n);
+        /// stops and joins the workers
+        virtual ~ThreadPool();
+        unsigned int concurrency() const {return workers.size()+1;}
+        void run(unsigned int n, const std::function<void (unsigned int)>& task);
+        /// return the process-wide pool of concurrency n. All Operations with the same
+        /// number of threads share it, unless they are given another Executor.
+        static std::shared_ptr<Executor> shared(unsigned int n);
+        /// the number of hardware threads, at least one
+        static unsigned int hardwareThreads();
+    private:
+        ThreadPool(const ThreadPool&);
+        ThreadPool& operator=(const ThreadPool&);
+        struct Batch;
+        /// run tasks of b until there are no more to start. Called with lock held, returns with it held.
+        void work(Batch& b, std::unique_lock<std::mutex>& lock);
+        /// the worker thread main loop
+        void loop();
+        /// the worker threads
+        std::vector<std::thread> workers;
+        /// batches with tasks left to start
+        std::deque< std::shared_ptr<Batch> > batches;
+        /// guards batches and the Batch counters
+        std::mutex mutex;
+        /// signalled when a batch is added, or the pool stops
+        std::condition_variable wake;
+        /// signalled when a task finishes
+        std::condition_variable done;
+        /// true when the workers should exit
+        bool stopping;
+};
+
+/// \brief work-stealing loop over [0, n) in chunks of at most grain
+///
+/// The range is split in one part per task of ex. Each task takes chunks from the front of
+/// its own part, and when that is empty steals chunks from the back of the other parts.
+/// body(begin, end, slot) is called for each chunk [begin, end). slot is the task number,
+/// less than ex.concurrency(), and no two chunks with the same slot run at the same time,
+/// so callers can keep per-slot work-vectors and counters without locking.
+void parallel_for(Executor& ex, unsigned int n, unsigned int grain,
+                  const std::function<void (unsigned int, unsigned int, unsigned int)>& body);
+
+} // end ocl namespace
+#endif
+// end file executor.hpp
@@ -0,0 +1,326 @@
+/*  $Id$
+ *
+ *  Copyright (c) 2010-2011 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *
+ *  This file is part of OpenCAMlib
+ *  (see https://github.com/aewallin/opencamlib).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FLATKDTREE_H
+#define FLATKDTREE_H
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <list>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cassert>
+
+#include <boost/foreach.hpp>
+
+#include "spatialindex.hpp"
+#include "bbox.hpp"
+#include "numeric.hpp"
+
+namespace ocl
+{
+
+/// \brief node of a FlatKDTree.
+///
+/// nodes are stored by value in one contiguous array. The two children of
+/// an internal node are always allocated next to each other, so only the
+/// index of the lo-child is stored, the hi-child is at child+1.
+/// A leaf refers to the range [child, child+count) of the permuted index array.
+struct FlatKDNode {
+    /// cut value, see KDNode::cutval
+    double cutval;
+    /// index of the lo child-node, or the first index-array entry for a leaf
+    unsigned int child;
+    /// number of objects in a leaf, zero for internal nodes
+    unsigned int count;
+    /// dimension of cut
+    int dim;
+    /// true if this is a leaf/bucket node
+    bool isLeaf() const { return count != 0; }
+};
+
+/// \brief a kd-tree stored in flat arrays
+///
+/// Cuts the objects in exactly the same way as KDTree, and keeps their input order
+/// within each side of a cut, so search() returns the same objects in the same order.
+/// The nodes live in one contiguous std::vector and the buckets are ranges of a single
+/// permuted index array.
+/// The objects themselves are not copied, the tree stores pointers into the
+/// list given to build(), which must outlive the tree.
+template <class BBObj>
+class FlatKDTree : public SpatialIndex<BBObj> {
+    public:
+        FlatKDTree() : buildTime(0), depth(0), nleaves(0), maxLeafSize(0) {}
+        virtual ~FlatKDTree() {}
+        /// build the kd-tree based on a list of input objects
+        void build(const std::list<BBObj>& list) {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            objs.clear();
+            objs.reserve( list.size() );
+            BOOST_FOREACH(const BBObj& o, list) {
+                objs.push_back( &o );
+            }
+            build_objs( start );
+        }
+        /// build the kd-tree based on pointers to input objects
+        void build(const std::vector<const BBObj*>& o) {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            objs = o;
+            build_objs( start );
+        }
+        /// search for overlap with input Bbox bb, return found objects
+        std::list<BBObj>* search( const Bbox& bb ) const {
+            assert( !this->dimensions.empty() );
+            std::list<BBObj>* tris = new std::list<BBObj>();
+            if ( !nodes.empty() )
+                this->search_node( tris, bb, 0 );
+            return tris;
+        }
+        /// search for overlap with input Bbox bb, place pointers to found objects in out
+        void search( const Bbox& bb, std::vector<const BBObj*>& out ) const {
+            assert( !this->dimensions.empty() );
+            out.clear();
+            if ( !nodes.empty() )
+                this->search_node( out, bb, 0 );
+        }
+        /// search for overlap with input Bbox bb, place list positions of found objects in out
+        void search( const Bbox& bb, std::vector<unsigned int>& out ) const {
+            assert( !this->dimensions.empty() );
+            out.clear();
+            if ( !nodes.empty() )
+                this->search_node( out, bb, 0 );
+        }
+        /// return the number of nodes in the tree
+        unsigned int size() const { return nodes.size(); }
+        /// return the time in seconds taken by the last call to build()
+        double getBuildTime() const { return buildTime; }
+        /// return the depth of the deepest leaf, the root is at depth zero
+        unsigned int getDepth() const { return depth; }
+        /// return the number of leaf/bucket nodes
+        unsigned int getLeafCount() const { return nleaves; }
+        /// return the number of objects in the fullest leaf
+        unsigned int getMaxLeafSize() const { return maxLeafSize; }
+        /// string repr, with the build time and tree statistics
+        std::string str() const {
+            std::ostringstream o;
+            o << name() << " N=" << objs.size() << " nodes=" << nodes.size() << " depth=" << depth;
+            o << " leaves=" << nleaves << " avg/max leaf size=";
+            o << (nleaves ? (double)index.size()/nleaves : 0.0) << "/" << maxLeafSize;
+            o << " build time=" << buildTime << " s";
+            return o.str();
+        }
+
+    protected:
+        /// name of the tree type, used by str()
+        virtual std::string name() const { return "FlatKDTree"; }
+        /// build the tree over objs, set by build(). start is the time build() was called
+        void build_objs(std::chrono::steady_clock::time_point start) {
+            nodes.clear();
+            index.clear();
+            if ( objs.empty() ) {
+                std::cout << "ERROR: FlatKDTree::build() called with list.size()==0 ! \n";
+                assert(0);
+                return;
+            }
+            index.resize( objs.size() );
+            for (unsigned int n=0; n<index.size(); ++n)
+                index[n] = n;
+            build_tree();
+            buildTime = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+            calc_stats();
+        }
+        /// build the nodes from the index array. objs and index are set up by build()
+        virtual void build_tree() {
+            nodes.reserve( 2*objs.size() ); // a binary tree with N non-empty leaves has at most 2N-1 nodes
+            nodes.push_back( FlatKDNode() );
+            build_node( 0, 0, index.size() );
+        }
+
+        /// walk the tree and update depth, nleaves, and maxLeafSize
+        void calc_stats() {
+            depth = 0;
+            nleaves = 0;
+            maxLeafSize = 0;
+            if ( nodes.empty() )
+                return;
+            std::vector< std::pair<unsigned int, unsigned int> > stack; // (node, depth)
+            stack.push_back( std::make_pair(0u, 0u) );
+            while ( !stack.empty() ) {
+                unsigned int n = stack.back().first;
+                unsigned int d = stack.back().second;
+                stack.pop_back();
+                if ( nodes[n].isLeaf() ) {
+                    ++nleaves;
+                    depth = std::max( depth, d );
+                    maxLeafSize = std::max( maxLeafSize, nodes[n].count );
+                } else {
+                    stack.push_back( std::make_pair( nodes[n].child  , d+1 ) );
+                    stack.push_back( std::make_pair( nodes[n].child+1, d+1 ) );
+                }
+            }
+        }
+
+        /// build node n from the index-array range [first, last)
+        void build_node(unsigned int n, unsigned int first, unsigned int last) {
+            int dim;
+            double spread, start;
+            calc_spread(first, last, dim, spread, start);
+            double cutvalue = start + spread/2; // cut in the middle
+            nodes[n].dim = dim;
+            nodes[n].cutval = cutvalue;
+            if ( ((last-first) <= this->bucketSize) || isZero_tol( spread ) ) { // a bucket/leaf node
+                nodes[n].child = first;
+                nodes[n].count = last-first;
+                return;
+            }
+            // partition the index range in place: lo-objects first, then hi-objects, each in
+            // input order as in the lists of KDTree::build_node()
+            unsigned int* mid = std::stable_partition( &index[0]+first, &index[0]+last,
+                                                       LoPredicate(objs, dim, cutvalue) );
+            unsigned int split = mid - &index[0];
+            assert( split > first && split < last ); // non-zero spread, so both sides are non-empty
+            unsigned int lo = nodes.size();
+            nodes[n].child = lo;
+            nodes[n].count = 0;
+            nodes.push_back( FlatKDNode() ); // lo child
+            nodes.push_back( FlatKDNode() ); // hi child, always at lo+1
+            build_node( lo  , first, split );
+            build_node( lo+1, split, last  );
+        }
+
+        /// calculate the largest spread of the objects in the index-array range [first, last)
+        /// among the tree dimensions. Ties are resolved as in KDTree::calc_spread().
+        void calc_spread(unsigned int first, unsigned int last, int& dim, double& spread, double& start) const {
+            double maxval[6];
+            double minval[6];
+            for (unsigned int m=0;m<this->dimensions.size();++m) {
+                int d = this->dimensions[m];
+                maxval[d] = minval[d] = objs[ index[first] ]->bb[d];
+            }
+            for (unsigned int i=first+1; i<last; ++i) {
+                const Bbox& bb = objs[ index[i] ]->bb;
+                for (unsigned int m=0;m<this->dimensions.size();++m) {
+                    int d = this->dimensions[m];
+                    double v = bb[d];
+                    if (maxval[d] < v)
+                        maxval[d] = v;
+                    if (minval[d] > v)
+                        minval[d] = v;
+                }
+            }
+            dim = this->dimensions[0];
+            spread = maxval[dim]-minval[dim];
+            start = minval[dim];
+            for (unsigned int m=1;m<this->dimensions.size();++m) {
+                int d = this->dimensions[m];
+                if ( maxval[d]-minval[d] > spread ) {
+                    dim = d;
+                    spread = maxval[d]-minval[d];
+                    start = minval[d];
+                }
+            }
+        }
+
+        /// search the tree starting at node n, looking for overlap with bb, and placing
+        /// found objects in *tris
+        void search_node( std::list<BBObj> *tris, const Bbox& bb, unsigned int n) const {
+            const FlatKDNode& node = nodes[n];
+            if ( node.isLeaf() ) {
+                for (unsigned int i=node.child; i<node.child+node.count; ++i)
+                    tris->push_back( *objs[ index[i] ] );
+            } else if ( (node.dim % 2) == 0 ) { // cutting along a min-direction: 0, 2, 4
+                if ( node.cutval <= bb[node.dim+1] )
+                    search_node( tris, bb, node.child+1 ); // hi
+                search_node( tris, bb, node.child ); // lo
+            } else { // cutting along a max-dimension: 1,3,5
+                search_node( tris, bb, node.child+1 ); // hi
+                if ( node.cutval >= bb[node.dim-1] )
+                    search_node( tris, bb, node.child ); // lo
+            }
+        }
+
+        /// as search_node() above, but place pointers to the found objects in out
+        void search_node( std::vector<const BBObj*>& out, const Bbox& bb, unsigned int n) const {
+            const FlatKDNode& node = nodes[n];
+            if ( node.isLeaf() ) {
+                for (unsigned int i=node.child; i<node.child+node.count; ++i)
+                    out.push_back( objs[ index[i] ] );
+            } else if ( (node.dim % 2) == 0 ) {
+                if ( node.cutval <= bb[node.dim+1] )
+                    search_node( out, bb, node.child+1 );
+                search_node( out, bb, node.child );
+            } else {
+                search_node( out, bb, node.child+1 );
+                if ( node.cutval >= bb[node.dim-1] )
+                    search_node( out, bb, node.child );
+            }
+        }
+
+        /// as search_node() above, but place the list positions of the found objects in out
+        void search_node( std::vector<unsigned int>& out, const Bbox& bb, unsigned int n) const {
+            const FlatKDNode& node = nodes[n];
+            if ( node.isLeaf() ) {
+                out.insert( out.end(), index.begin()+node.child, index.begin()+node.child+node.count );
+            } else if ( (node.dim % 2) == 0 ) {
+                if ( node.cutval <= bb[node.dim+1] )
+                    search_node( out, bb, node.child+1 );
+                search_node( out, bb, node.child );
+            } else {
+                search_node( out, bb, node.child+1 );
+                if ( node.cutval >= bb[node.dim-1] )
+                    search_node( out, bb, node.child );
+            }
+        }
+
+        /// predicate for std::partition, true for objects that belong in the lo child
+        class LoPredicate {
+            public:
+                LoPredicate(const std::vector<const BBObj*>& o, int d, double c)
+                    : objects(o), dim(d), cutval(c) {}
+                bool operator()(unsigned int i) const { return !( objects[i]->bb[dim] > cutval ); }
+            private:
+                const std::vector<const BBObj*>& objects;
+                int dim;
+                double cutval;
+        };
+
+    // DATA
+        /// the objects, in the order they were given to build()
+        std::vector<const BBObj*> objs;
+        /// permuted indices into objs. Each leaf is a contiguous range of this array.
+        std::vector<unsigned int> index;
+        /// the nodes of the tree, nodes[0] is the root
+        std::vector<FlatKDNode> nodes;
+        /// time in seconds taken by build()
+        double buildTime;
+        /// depth of the deepest leaf
+        unsigned int depth;
+        /// number of leaf nodes
+        unsigned int nleaves;
+        /// number of objects in the fullest leaf
+        unsigned int maxLeafSize;
+};
+
+} // end ocl namespace
+#endif
+// end file flatkdtree.hpp
@@ -0,0 +1,109 @@
+/*  $Id$
+ *
+ *  Copyright (c) 2010-2011 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *
+ *  This file is part of OpenCAMlib
+ *  (see https://github.com/aewallin/opencamlib).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef INDEXCACHE_H
+#define INDEXCACHE_H
+
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ocl
+{
+
+template <class BBObj> class SpatialIndex;
+
+/// \brief a cache of built spatial indexes over one list of objects
+///
+/// Indexes are keyed on their type, bucket-size and search dimensions, so
+/// e.g. all Waterline operations on one STLSurf share the same two trees, no
+/// matter how many Z-levels are run. The cached indexes are immutable and can
+/// be searched from many threads at the same time. An index is built outside the lock,
+/// so indexes with different keys build in parallel, and callers that ask for an
+/// index while it is built wait for that build only.
+/// A copy of a cache is empty, since the cached indexes point into the objects
+/// of the original. The owner of the objects must call clear() when they change.
+template <class BBObj>
+class IndexCache {
+    public:
+        /// a shared, built index
+        typedef std::shared_ptr< const SpatialIndex<BBObj> > Index;
+        IndexCache() {}
+        /// copy-constructor, the copy starts out empty
+        IndexCache(const IndexCache&) {}
+        /// assignment, empties the cache
+        IndexCache& operator=(const IndexCache&) {
+            clear();
+            return *this;
+        }
+        /// return the cached index with the same type, bucket-size and dimensions as idx.
+        /// If there is none, idx is built from objs, cached and returned.
+        /// Takes ownership of idx, which must not yet be built.
+        Index get(int type, SpatialIndex<BBObj>* idx, const std::list<BBObj>& objs) {
+            std::vector<int> key;
+            key.push_back( type );
+            key.push_back( idx->getBucketSize() );
+            key.insert( key.end(), idx->getDimensions().begin(), idx->getDimensions().end() );
+            std::promise<Index> built;
+            Slot cached;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                typename std::map< std::vector<int>, Slot >::iterator it = indexes.find( key );
+                if ( it != indexes.end() )
+                    cached = it->second;
+                else
+                    indexes[key] = built.get_future().share();
+            }
+            if ( cached.valid() ) {
+                delete idx;
+                return cached.get(); // waits, without the lock, if another thread is building it
+            }
+            idx->build( objs );
+            Index index( idx );
+            built.set_value( index );
+            return index;
+        }
+        /// remove all indexes. Operations that already got an index keep it.
+        void clear() {
+            std::lock_guard<std::mutex> lock(mutex);
+            indexes.clear();
+        }
+        /// return the number of cached indexes
+        unsigned int size() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            return indexes.size();
+        }
+
+    private:
+        /// a cached index, ready when its build is done
+        typedef std::shared_future<Index> Slot;
+        /// the cached indexes
+        std::map< std::vector<int>, Slot > indexes;
+        /// guards indexes
+        mutable std::mutex mutex;
+};
+
+} // end ocl namespace
+#endif
+// end file indexcache.hpp
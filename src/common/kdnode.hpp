@@ -26,6 +26,7 @@
 #include <string>
 
 #include <list>
+#include <vector>
 
 namespace ocl
 {
@@ -96,6 +97,8 @@ class KDNode {
         KDNode* lo; 
         /// A list of triangles, if this is a bucket-node (NULL for internal nodes)
         std::list< BBObj >* tris;
+        /// for a bucket-node, the position of each object of tris in the list given to KDTree::build()
+        std::vector<unsigned int> ids;
         /// flag to indicate leaf in the tree. Leafs or bucket-nodes contain triangles in the list tris.
         bool isLeaf;
 };
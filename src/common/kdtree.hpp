@@ -23,11 +23,17 @@
 #define KDTREE_H
 
 #include <iostream>
+#include <sstream>
+#include <string>
 #include <list>
+#include <vector>
+#include <algorithm>
+#include <cassert>
 
 #include <boost/foreach.hpp>
 
 #include "kdnode.hpp"
+#include "spatialindex.hpp"
 #include "bbox.hpp"
 #include "millingcutter.hpp"
 #include "clpoint.hpp"
@@ -72,7 +78,7 @@ class Spread {
 /// a kd-tree for storing triangles and fast searching for triangles
 /// that overlap the cutter
 template <class BBObj>
-class KDTree {
+class KDTree : public SpatialIndex<BBObj> {
     public:
         KDTree() {
 	    root = nullptr;
@@ -81,64 +87,56 @@ class KDTree {
             // std::cout << " ~KDTree()" << std::endl;
 	    delete root;
         }
-        /// set the bucket-size 
-        void setBucketSize(int b){
-            //std::cout << "KDTree::setBucketSize = " << b << "\n"; 
-            bucketSize = b;
-        }
-        /// set the search dimension to the XY-plane
-        void setXYDimensions(){
-            //std::cout << "KDTree::setXYDimensions()\n"; 
-            dimensions.clear();
-            dimensions.push_back(0); // x
-            dimensions.push_back(1); // x
-            dimensions.push_back(2); // y
-            dimensions.push_back(3); // y
-        } // for drop-cutter search in XY plane
-        /// set search-plane to YZ
-        void setYZDimensions(){ // for X-fibers
-            //std::cout << "KDTree::setYZDimensions()\n"; 
-            dimensions.clear();
-            dimensions.push_back(2); // y
-            dimensions.push_back(3); // y
-            dimensions.push_back(4); // z
-            dimensions.push_back(5); // z
-        } // for X-fibers
-        /// set search plane to XZ
-        void setXZDimensions(){ // for Y-fibers
-            //std::cout << "KDTree::setXZDimensions()\n";
-            dimensions.clear();
-            dimensions.push_back(0); // x
-            dimensions.push_back(1); // x
-            dimensions.push_back(4); // z
-            dimensions.push_back(5); // z
-        } // for Y-fibers
         /// build the kd-tree based on a list of input objects
-        void build(const std::list<BBObj>& list){
+        virtual void build(const std::list<BBObj>& list){
             //std::cout << "KDTree::build() list.size()= " << list.size() << " \n";
 	    delete root;
-	    root = build_node( &list, 0, NULL ); 
+	    std::vector<unsigned int> ids( list.size() );
+	    for (unsigned int n=0; n<ids.size(); ++n)
+	        ids[n] = n;
+	    root = build_node( &list, &ids, 0, NULL ); 
+        }
+        /// build the kd-tree based on pointers to input objects. The buckets hold copies
+        /// of the objects, as with a list.
+        virtual void build(const std::vector<const BBObj*>& objs) {
+            std::list<BBObj> list;
+            BOOST_FOREACH(const BBObj* o, objs) {
+                list.push_back( *o );
+            }
+            KDTree<BBObj>::build( list );
         }
         /// search for overlap with input Bbox bb, return found objects
-        std::list<BBObj>* search( const Bbox& bb ){
-            assert( !dimensions.empty() );
+        virtual std::list<BBObj>* search( const Bbox& bb ) const {
+            assert( !this->dimensions.empty() );
             std::list<BBObj>* tris = new std::list<BBObj>();
             this->search_node( tris, bb, root );
             return tris;
         }
-        /// search for overlap with a MillingCutter c positioned at cl, return found objects
-        std::list<BBObj>* search_cutter_overlap(const MillingCutter* c, CLPoint* cl ){
-            double r = c->getRadius();
-            // build a bounding-box at the current CL
-            Bbox bb( cl->x-r, cl->x+r, cl->y-r, cl->y+r, cl->z, cl->z+c->getLength() );    
-            return this->search( bb );
+        /// search for overlap with input Bbox bb, and place pointers to the found objects
+        /// in the caller-owned vector out. out is cleared first, but its storage is 
+        /// re-used, so repeated searches with the same vector do not allocate memory.
+        virtual void search( const Bbox& bb, std::vector<const BBObj*>& out ) const {
+            assert( !this->dimensions.empty() );
+            out.clear();
+            this->search_node( out, bb, root );
+        }
+        /// search for overlap with input Bbox bb, and place the list positions of the found objects in out
+        virtual void search( const Bbox& bb, std::vector<unsigned int>& out ) const {
+            assert( !this->dimensions.empty() );
+            out.clear();
+            this->search_node( out, bb, root );
         }
         /// string repr
-        std::string str() const;
+        virtual std::string str() const {
+            std::ostringstream o;
+            o << "KDTree bucketSize=" << this->bucketSize;
+            return o.str();
+        }
         
     protected:
         /// build and return a KDNode containing list *tris at depth dep.
         KDNode<BBObj>* build_node(     const std::list<BBObj> *tris,  // triangles 
+                                        const std::vector<unsigned int>* ids, // list positions of tris
                                         int dep,                       // depth of node
                                         KDNode<BBObj> *par)   {       // parent node
             //std::cout << "KDNode::build_node list.size()=" << tris->size() << "\n";
@@ -151,10 +149,11 @@ class KDTree {
             Spread* spr = calc_spread(tris); // calculate spread in order to know how to cut
             double cutvalue = spr->start + spr->val/2; // cut in the middle
             //std::cout << " cutvalue= " << cutvalue << "\n";
-            if ( (tris->size() <= bucketSize) ||  isZero_tol( spr->val ) ) {  // then return a bucket/leaf node
+            if ( (tris->size() <= this->bucketSize) ||  isZero_tol( spr->val ) ) {  // then return a bucket/leaf node
                 //std::cout << "KDNode::build_node BUCKET list.size()=" << tris->size() << "\n";
                 KDNode<BBObj> *bucket;   //  dim   cutv   parent   hi    lo   triangles depth
                 bucket = new KDNode<BBObj>(spr->d, cutvalue , par , NULL, NULL, tris, dep);
+                bucket->ids = *ids;
                 assert( bucket->isLeaf );
                 delete spr;
                 return bucket; // this is the leaf/end of the recursion-tree
@@ -162,11 +161,18 @@ class KDTree {
             // build lists of triangles for hi and lo child nodes
             std::list<BBObj>* lolist = new std::list<BBObj>();
             std::list<BBObj>* hilist = new std::list<BBObj>();
+            std::vector<unsigned int> loids;
+            std::vector<unsigned int> hiids;
+            std::vector<unsigned int>::const_iterator id = ids->begin();
             BOOST_FOREACH(BBObj t, *tris) { // loop through each triangle and put it in either lolist or hilist
-                if (t.bb[spr->d] > cutvalue) 
+                if (t.bb[spr->d] > cutvalue) {
                     hilist->push_back(t);
-                else
+                    hiids.push_back(*id);
+                } else {
                     lolist->push_back(t);
+                    loids.push_back(*id);
+                }
+                ++id;
             } 
             
             /*
@@ -190,12 +196,12 @@ class KDTree {
             // create the child-nodes through recursion
             //                    list    depth   parent
             if (!hilist->empty())
-                node->hi = build_node(hilist, dep+1, node); 
+                node->hi = build_node(hilist, &hiids, dep+1, node); 
             //else
                 //std::cout << "hilist empty!\n";
                 
             if (!lolist->empty()) {
-                node->lo = build_node(lolist, dep+1, node); 
+                node->lo = build_node(lolist, &loids, dep+1, node); 
             } else {
                 //std::cout << "lolist empty!\n";
             }
@@ -222,27 +228,27 @@ class KDTree {
                 //std::cout << "calc_spread()...\n";
                 bool first=true;
                 BOOST_FOREACH(BBObj t, *tris) { // check each triangle
-                    for (unsigned int m=0;m<dimensions.size();++m) {
+                    for (unsigned int m=0;m<this->dimensions.size();++m) {
                         // dimensions[m] is the dimensions we want to update
                         // t.bb[ dimensions[m] ]   is the update value
                         if (first) {
-                            maxval[ dimensions[m] ] = t.bb[ dimensions[m] ];
-                            minval[ dimensions[m] ] = t.bb[ dimensions[m] ];
-                            if (m==(dimensions.size()-1) )
+                            maxval[ this->dimensions[m] ] = t.bb[ this->dimensions[m] ];
+                            minval[ this->dimensions[m] ] = t.bb[ this->dimensions[m] ];
+                            if (m==(this->dimensions.size()-1) )
                                 first=false;
                         } else {
-                            if (maxval[ dimensions[m] ] < t.bb[ dimensions[m] ] )
-                                maxval[ dimensions[m] ] = t.bb[ dimensions[m] ];
-                            if (minval[ dimensions[m] ] > t.bb[ dimensions[m] ])
-                                minval[ dimensions[m] ] = t.bb[ dimensions[m] ];
+                            if (maxval[ this->dimensions[m] ] < t.bb[ this->dimensions[m] ] )
+                                maxval[ this->dimensions[m] ] = t.bb[ this->dimensions[m] ];
+                            if (minval[ this->dimensions[m] ] > t.bb[ this->dimensions[m] ])
+                                minval[ this->dimensions[m] ] = t.bb[ this->dimensions[m] ];
                         }
                     }
                 } 
                 std::vector<Spread*> spreads;// calculate the spread along each dimension
-                for (unsigned int m=0;m<dimensions.size();++m) {   // dim,  spread, start
-                    spreads.push_back( new Spread(dimensions[m] , 
-                                       maxval[dimensions[m]]-minval[dimensions[m]], 
-                                       minval[dimensions[m]] ) );  
+                for (unsigned int m=0;m<this->dimensions.size();++m) {   // dim,  spread, start
+                    spreads.push_back( new Spread(this->dimensions[m] , 
+                                       maxval[this->dimensions[m]]-minval[this->dimensions[m]], 
+                                       minval[this->dimensions[m]] ) );  
                 }// priority-queue could also be used ??  
                 assert( !spreads.empty() );
                 //std::cout << " spreads.size()=" << spreads.size() << "\n";
@@ -257,7 +263,7 @@ class KDTree {
         
         /// search kd-tree starting at *node, looking for overlap with bb, and placing
         /// found objects in *tris
-        void search_node( std::list<BBObj> *tris, const Bbox& bb, KDNode<BBObj> *node) {
+        void search_node( std::list<BBObj> *tris, const Bbox& bb, KDNode<BBObj> *node) const {
             if (node->isLeaf ) { // we found a bucket node, so add all triangles and return.
             
                 BOOST_FOREACH( BBObj t, *(node->tris) ) {
@@ -289,13 +295,60 @@ class KDTree {
             }
             return; // Done. We get here after all the recursive calls above.
         } // end search_kdtree();
+        
+        /// as search_node() above, but place pointers to the found objects in out
+        void search_node( std::vector<const BBObj*>& out, const Bbox& bb, KDNode<BBObj> *node) const {
+            if (node->isLeaf ) {
+                BOOST_FOREACH( const BBObj& t, *(node->tris) ) {
+                    out.push_back(&t); 
+                } 
+            } else if ( (node->dim % 2) == 0) { // cutting along a min-direction: 0, 2, 4
+                if ( node->cutval > bb[node->dim+1] ) { // search only lo
+                    search_node(out, bb, node->lo );
+                } else {
+                    if (node->hi)
+                        search_node(out, bb, node->hi );
+                    if (node->lo)
+                        search_node(out, bb, node->lo );
+                }
+            } else { // cutting along a max-dimension: 1,3,5
+                if ( node->cutval < bb[node->dim-1] ) { // search only hi
+                    search_node(out, bb, node->hi);
+                } else {
+                    if (node->hi)
+                        search_node(out, bb, node->hi);
+                    if (node->lo)
+                        search_node(out, bb, node->lo);
+                }
+            }
+        }
+        /// as search_node() above, but place the list positions of the found objects in out
+        void search_node( std::vector<unsigned int>& out, const Bbox& bb, KDNode<BBObj> *node) const {
+            if (node->isLeaf ) {
+                out.insert( out.end(), node->ids.begin(), node->ids.end() );
+            } else if ( (node->dim % 2) == 0) { // cutting along a min-direction: 0, 2, 4
+                if ( node->cutval > bb[node->dim+1] ) { // search only lo
+                    search_node(out, bb, node->lo );
+                } else {
+                    if (node->hi)
+                        search_node(out, bb, node->hi );
+                    if (node->lo)
+                        search_node(out, bb, node->lo );
+                }
+            } else { // cutting along a max-dimension: 1,3,5
+                if ( node->cutval < bb[node->dim-1] ) { // search only hi
+                    search_node(out, bb, node->hi);
+                } else {
+                    if (node->hi)
+                        search_node(out, bb, node->hi);
+                    if (node->lo)
+                        search_node(out, bb, node->lo);
+                }
+            }
+        }
     // DATA
-        /// bucket size of tree
-        unsigned int bucketSize;
         /// pointer to root KDNode
         KDNode<BBObj>* root;
-        /// the dimensions in this kd-tree
-        std::vector<int> dimensions;
 };
 
 } // end ocl namespace
@@ -0,0 +1,227 @@
+/*  $Id$
+ *
+ *  Copyright (c) 2010-2011 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *
+ *  This file is part of OpenCAMlib
+ *  (see https://github.com/aewallin/opencamlib).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SAHKDTREE_H
+#define SAHKDTREE_H
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <memory>
+
+#include "flatkdtree.hpp"
+#include "numeric.hpp"
+#include "executor.hpp"
+
+namespace ocl
+{
+
+/// \brief a FlatKDTree with cuts chosen by a binned surface-area-heuristic (SAH) cost
+///
+/// The node layout and search() are those of FlatKDTree. Instead of always
+/// cutting the largest spread in the middle, build() evaluates NBINS candidate
+/// cuts along each tree dimension and picks the one with the lowest expected
+/// search cost. A search always visits one child of a node and visits the
+/// other only if the query box reaches across the cut, so the cost of a cut is
+///   1 + n_near + P_far * n_far
+/// where P_far is the fraction of the node's extent (widened by the mean object
+/// size, as a stand-in for the unknown query size) that lies beyond the cut.
+/// A node becomes a leaf if it holds at most bucketSize objects, or if no cut is
+/// cheaper than the leaf and it holds at most leafLimit objects.
+///
+/// Subtrees with more than taskSize objects are built as two tasks on the Executor
+/// set with setExecutor(), usually that of the Operation, see Operation::newIndex().
+/// Without an Executor the tree is built on the calling thread. Objects are
+/// partitioned in place in the shared index array, and child nodes are allocated
+/// in pairs with an atomic counter, so tasks never touch the same data.
+template <class BBObj>
+class SAHKDTree : public FlatKDTree<BBObj> {
+    public:
+        SAHKDTree() : leafLimit(8), taskSize(4096) {}
+        virtual ~SAHKDTree() {}
+        /// set the largest leaf that is kept when splitting does not pay off.
+        /// getMaxLeafSize() reports the fullest leaf of the built tree.
+        void setLeafLimit(unsigned int s) { leafLimit = s; }
+        /// set the smallest subtree whose two halves are built as separate tasks
+        void setTaskSize(unsigned int s) { taskSize = s; }
+        /// build on the threads of e, see Operation::setExecutor()
+        void setExecutor(std::shared_ptr<Executor> e) { executor = e; }
+
+    protected:
+        /// number of candidate cuts per dimension is NBINS-1
+        static const int NBINS = 32;
+
+        std::string name() const { return "SAHKDTree"; }
+
+        /// build the tree, in parallel if there is an Executor
+        void build_tree() {
+            // a binary tree with N non-empty leaves has at most 2N-1 nodes,
+            // so the array never needs to grow while tasks are running.
+            this->nodes.resize( 2*this->objs.size() );
+            nextNode = 1;
+            build_sah( 0, 0, this->index.size() );
+            this->nodes.resize( nextNode );
+            executor.reset(); // a built tree may be cached long after the Operation is gone
+        }
+
+        /// build node n from the index-array range [first, last)
+        void build_sah(unsigned int n, unsigned int first, unsigned int last) {
+            const unsigned int N = last-first;
+            FlatKDNode& node = this->nodes[n];
+            double minval[6];
+            double maxval[6];
+            double extent[3] = {0, 0, 0};
+            calc_bounds(first, last, minval, maxval, extent);
+            // the KDTree cut: middle of the largest spread
+            int dim = this->dimensions[0];
+            for (unsigned int m=1;m<this->dimensions.size();++m) {
+                int d = this->dimensions[m];
+                if ( maxval[d]-minval[d] > maxval[dim]-minval[dim] )
+                    dim = d;
+            }
+            const int middim = dim;
+            const double midcut = minval[dim] + (maxval[dim]-minval[dim])/2;
+            node.dim = dim;
+            node.cutval = midcut;
+            if ( (N <= this->bucketSize) || isZero_tol( maxval[dim]-minval[dim] ) ) {
+                make_leaf(node, first, N);
+                return;
+            }
+            double cost;
+            find_cut(first, last, minval, maxval, extent, dim, node.cutval, cost);
+            node.dim = dim;
+            if ( (cost >= N) && (N <= leafLimit) ) { // splitting costs more than scanning the leaf
+                make_leaf(node, first, N);
+                return;
+            }
+            typedef typename FlatKDTree<BBObj>::LoPredicate LoPredicate;
+            unsigned int* begin = &(this->index[0]);
+            unsigned int* mid = std::partition( begin+first, begin+last, LoPredicate(this->objs, node.dim, node.cutval) );
+            unsigned int split = mid - begin;
+            if ( split == first || split == last ) {
+                // an object on a bin edge landed on the other side of the cut than binning
+                // assumed. Fall back to the KDTree cut, which always separates the objects.
+                node.dim = middim;
+                node.cutval = midcut;
+                mid = std::partition( begin+first, begin+last, LoPredicate(this->objs, node.dim, node.cutval) );
+                split = mid - begin;
+            }
+            assert( split > first && split < last );
+            unsigned int lo = nextNode.fetch_add(2);
+            node.child = lo;
+            node.count = 0;
+            if ( executor && executor->concurrency() > 1 && N > taskSize ) {
+                // Executor::run() returns when both halves are done, and may be called from inside a task
+                executor->run( 2, [&](unsigned int k) {
+                    if ( k == 0 )
+                        build_sah( lo, first, split );
+                    else
+                        build_sah( lo+1, split, last );
+                } );
+            } else {
+                build_sah( lo, first, split );
+                build_sah( lo+1, split, last );
+            }
+        }
+
+        /// turn node into a leaf with the count objects starting at index[first]
+        void make_leaf(FlatKDNode& node, unsigned int first, unsigned int count) const {
+            node.child = first;
+            node.count = count;
+        }
+
+        /// find the bounds of the tree dimensions, and the summed extent of
+        /// the objects along x, y, z, in the index-array range [first, last)
+        void calc_bounds(unsigned int first, unsigned int last,
+                         double* minval, double* maxval, double* extent) const {
+            for (unsigned int m=0;m<this->dimensions.size();++m) {
+                int d = this->dimensions[m];
+                minval[d] = maxval[d] = this->objs[ this->index[first] ]->bb[d];
+            }
+            for (unsigned int i=first; i<last; ++i) {
+                const Bbox& bb = this->objs[ this->index[i] ]->bb;
+                for (unsigned int m=0;m<this->dimensions.size();++m) {
+                    int d = this->dimensions[m];
+                    minval[d] = std::min( minval[d], bb[d] );
+                    maxval[d] = std::max( maxval[d], bb[d] );
+                }
+                for (int a=0;a<3;++a)
+                    extent[a] += bb[2*a+1] - bb[2*a];
+            }
+        }
+
+        /// evaluate NBINS-1 cuts along each tree dimension and return the cheapest in dim, cutval, cost.
+        /// dim and cutval are left unchanged if no candidate cut separates the objects.
+        void find_cut(unsigned int first, unsigned int last, const double* minval, const double* maxval,
+                      const double* extent, int& dim, double& cutval, double& cost) const {
+            const unsigned int N = last-first;
+            cost = 2*N; // worse than any valid cut
+            for (unsigned int m=0;m<this->dimensions.size();++m) {
+                int d = this->dimensions[m];
+                double lo = minval[d];
+                double hi = maxval[d];
+                if ( isZero_tol( hi-lo ) )
+                    continue;
+                unsigned int bins[NBINS] = {0};
+                double scale = NBINS/(hi-lo);
+                for (unsigned int i=first; i<last; ++i) {
+                    int b = (int)( (this->objs[ this->index[i] ]->bb[d]-lo)*scale );
+                    bins[ std::min( std::max(b, 0), NBINS-1 ) ]++;
+                }
+                double w = extent[d/2]/N; // mean object size along the axis of d
+                double total = (hi-lo) + w;
+                unsigned int nlo = 0;
+                for (int k=1; k<NBINS; ++k) {
+                    nlo += bins[k-1];
+                    unsigned int nhi = N-nlo;
+                    if ( nlo == 0 || nhi == 0 )
+                        continue;
+                    double c = lo + k*(hi-lo)/NBINS;
+                    double kcost;
+                    if ( (d % 2) == 0 ) // min-dimension: lo always searched, hi if the query reaches above c
+                        kcost = 1 + nlo + nhi*( (hi-c) + w )/total;
+                    else                // max-dimension: hi always searched, lo if the query reaches below c
+                        kcost = 1 + nhi + nlo*( (c-lo) + w )/total;
+                    if ( kcost < cost ) {
+                        cost = kcost;
+                        dim = d;
+                        cutval = c;
+                    }
+                }
+            }
+        }
+
+    // DATA
+        /// largest leaf kept when no cut is cheaper
+        unsigned int leafLimit;
+        /// subtrees larger than this are built as two tasks on executor
+        unsigned int taskSize;
+        /// runs the subtree tasks, or none to build on the calling thread
+        std::shared_ptr<Executor> executor;
+        /// next free slot in nodes
+        std::atomic<unsigned int> nextNode;
+};
+
+} // end ocl namespace
+#endif
+// end file sahkdtree.hpp
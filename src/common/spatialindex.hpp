@@ -0,0 +1,133 @@
+/*  $Id$
+ *
+ *  Copyright (c) 2010-2011 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *
+ *  This file is part of OpenCAMlib
+ *  (see https://github.com/aewallin/opencamlib).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SPATIALINDEX_H
+#define SPATIALINDEX_H
+
+#include <string>
+#include <list>
+#include <vector>
+
+#include "bbox.hpp"
+#include "millingcutter.hpp"
+#include "clpoint.hpp"
+
+namespace ocl
+{
+
+class Point;
+class CLPoint;
+class MillingCutter;
+
+/// \brief interface for spatial indexes that find the objects overlapping a Bbox
+///
+/// The index is searched in a plane given by four of the six Bbox dimensions
+/// (see Bbox::operator[]), set with setXYDimensions() for drop-cutter and with
+/// setYZDimensions()/setXZDimensions() for X- and Y-fibers of push-cutter.
+/// The other two dimensions are ignored, so a search may return objects that do not
+/// overlap in them. Searches never miss an overlapping object.
+/// Searches do not modify the index, so a built index can be shared
+/// between operations and threads, see IndexCache.
+template <class BBObj>
+class SpatialIndex {
+    public:
+        SpatialIndex() : bucketSize(1) {}
+        virtual ~SpatialIndex() {}
+        /// set the bucket-size, the number of objects stored in a leaf node
+        void setBucketSize(int b) {
+            bucketSize = b;
+        }
+        /// return the bucket-size
+        unsigned int getBucketSize() const { return bucketSize; }
+        /// return the Bbox dimensions searched
+        const std::vector<int>& getDimensions() const { return dimensions; }
+        /// set the search dimension to the XY-plane
+        void setXYDimensions() {
+            dimensions.clear();
+            dimensions.push_back(0); // x
+            dimensions.push_back(1); // x
+            dimensions.push_back(2); // y
+            dimensions.push_back(3); // y
+        } // for drop-cutter search in XY plane
+        /// set search-plane to YZ
+        void setYZDimensions() {
+            dimensions.clear();
+            dimensions.push_back(2); // y
+            dimensions.push_back(3); // y
+            dimensions.push_back(4); // z
+            dimensions.push_back(5); // z
+        } // for X-fibers
+        /// set search plane to XZ
+        void setXZDimensions() {
+            dimensions.clear();
+            dimensions.push_back(0); // x
+            dimensions.push_back(1); // x
+            dimensions.push_back(4); // z
+            dimensions.push_back(5); // z
+        } // for Y-fibers
+        /// build the index from a list of input objects. The index may keep pointers
+        /// into the list, so it must outlive the index.
+        virtual void build(const std::list<BBObj>& list) = 0;
+        /// build the index from pointers to the input objects, e.g. to some of the objects
+        /// of a list. The index may keep the pointers, so the objects must outlive the index.
+        /// search() with list positions returns positions in objs.
+        virtual void build(const std::vector<const BBObj*>& objs) = 0;
+        /// search for overlap with input Bbox bb, return found objects
+        virtual std::list<BBObj>* search( const Bbox& bb ) const = 0;
+        /// search for overlap with input Bbox bb, and place pointers to the found objects
+        /// in the caller-owned vector out. out is cleared first, but its storage is
+        /// re-used, so repeated searches with the same vector do not allocate memory.
+        virtual void search( const Bbox& bb, std::vector<const BBObj*>& out ) const = 0;
+        /// search for overlap with input Bbox bb, and place the positions in the list given
+        /// to build() of the found objects in out. Used to look up per-object data stored
+        /// in arrays, such as TriangleStore. out is cleared first.
+        virtual void search( const Bbox& bb, std::vector<unsigned int>& out ) const = 0;
+        /// search for overlap with a MillingCutter c positioned at cl, return found objects
+        std::list<BBObj>* search_cutter_overlap(const MillingCutter* c, CLPoint* cl ) const {
+            return this->search( cutter_bbox(c, cl) );
+        }
+        /// search for overlap with a MillingCutter c positioned at cl, place found objects in out
+        void search_cutter_overlap(const MillingCutter* c, const Point* cl, std::vector<const BBObj*>& out ) const {
+            this->search( cutter_bbox(c, cl), out );
+        }
+        /// search for overlap with a MillingCutter c positioned at cl, place list positions of found objects in out
+        void search_cutter_overlap(const MillingCutter* c, const Point* cl, std::vector<unsigned int>& out ) const {
+            this->search( cutter_bbox(c, cl), out );
+        }
+        /// string repr
+        virtual std::string str() const = 0;
+
+    protected:
+        /// return a bounding-box around the MillingCutter c positioned at cl
+        static Bbox cutter_bbox(const MillingCutter* c, const Point* cl) {
+            double r = c->getRadius();
+            return Bbox( cl->x-r, cl->x+r, cl->y-r, cl->y+r, cl->z, cl->z+c->getLength() );
+        }
+    // DATA
+        /// bucket size of the leaf nodes
+        unsigned int bucketSize;
+        /// the Bbox dimensions searched
+        std::vector<int> dimensions;
+};
+
+} // end ocl namespace
+#endif
+// end file spatialindex.hpp
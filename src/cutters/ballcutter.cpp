@@ -26,6 +26,7 @@
 #include <boost/foreach.hpp>
 
 #include "ballcutter.hpp"
+#include "dropkernel.hpp"
 
 namespace ocl
 {
@@ -134,5 +135,8 @@ std::ostream& operator<<(std::ostream &stream, BallCutter c) {
 	return stream;
 }
 
+// the drop-cutter kernel, compiled here where height() and singleEdgeDropCanonical() can be inlined
+template class DropKernel<BallCutter>;
+
 } // end namespace
 // end file ballcutter.cpp
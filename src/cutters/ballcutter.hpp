@@ -24,6 +24,7 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <cmath>
 
 #include "millingcutter.hpp"
 #include "numeric.hpp"
@@ -34,6 +35,8 @@ namespace ocl
 /// \brief Ball or Spherical MillingCutter (ball-nose endmill)
 ///
 class BallCutter : public MillingCutter {
+    template <class C> friend class DropKernel;
+
     public:
         BallCutter();
         /// create a BallCutter with diameter d (radius d/2) and length l
@@ -43,6 +46,8 @@ class BallCutter : public MillingCutter {
         /// string repr
         friend std::ostream& operator<<(std::ostream &stream, BallCutter c);
         std::string str() const;
+        /// the sphere touches the plane where its normal is the plane normal
+        bool slopeBound(double& flat, double& round) const {flat = 0.0; round = radius; return true;}
     protected:
         CC_CLZ_Pair singleEdgeDropCanonical(const Point& u1, const Point& u2) const;
         bool generalEdgePush(const Fiber& f, Interval& i,  const Point& p1, const Point& p2) const;
@@ -21,10 +21,13 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <algorithm>
 
 #include <boost/foreach.hpp>
 
 #include "bullcutter.hpp"
+#include "dropkernel.hpp"
+#include "ellipsesolver.hpp"
 #include "numeric.hpp"
 
 namespace ocl
@@ -80,32 +83,85 @@ double BullCutter::width(double h) const {
 // results in an ellipse with a shorter axis of radius2, and a longer axis of radius2/sin(theta)
 // where theta is the slope of the edge in the XZ plane
 CC_CLZ_Pair BullCutter::singleEdgeDropCanonical( const Point& u1, const Point& u2 ) const {
-    if ( isZero_tol( u1.z - u2.z ) ) {  // horizontal edge special case
-        return CC_CLZ_Pair( 0 , u1.z - height(u1.y) );
-    } else { // the general offset-ellipse case
-        double b_axis = radius2;                            // short axis of ellipse = radius2
-        double theta = atan( (u2.z - u1.z) / (u2.x-u1.x) ); // theta is the slope of the line
-        double a_axis = fabs( radius2/sin(theta) );         // long axis of ellipse = radius2/sin(theta)       
-        Point ellcenter(0,u1.y,0);
-        Ellipse e = Ellipse( ellcenter, a_axis, b_axis, radius1); // radius1 is the ellipse-offset
-        int iters = e.solver_brent(); // numerical solver that searches for a point on the ellipse
-                                      // such that a radius1-length normal-vector from this ellipse-point
-                                      // is at the CL point (0,0)
-        if (iters > 200)
-            std::cout << "WARNING: BullCutter::singleEdgeDropCanonical() iters>200 !!\n";
-        assert( iters < 200 );
-        e.setEllipsePositionHi(u1,u2); // this selects either EllipsePosition1 or 
-                                       // EllipsePosition2 and sets it to EllipsePosition_hi
-        // pseudo cc-point on the ellipse/cylinder, in the CL=(0,0) system
-        Point ell_ccp = e.ePointHi();
-        assert( fabs( ell_ccp.xyNorm() - radius1 ) < 1E-5); // ell_ccp should be on the cylinder-circle  
-        Point cc_tmp_u = ell_ccp.closestPoint(u1,u2); // find cc-point on u1-u2 edge
-        return CC_CLZ_Pair( cc_tmp_u.x , e.getCenterZ()-radius2);
+    // the same solver as the DropKernel batch path, so that all drop-cutters give the same z
+    CC_CLZ_Pair contact;
+    edgeDropCanonical( 1, &u1, &u2, &contact );
+    return contact;
+}
+
+void BullCutter::edgeDropCanonical(unsigned int n, const Point* u1, const Point* u2, CC_CLZ_Pair* contact) const {
+    // the offset-ellipse cases, EDGE_BATCH at a time
+    static const unsigned int EDGE_BATCH = 8;
+    for (unsigned int k=0; k<n; k+=EDGE_BATCH) {
+        const unsigned int m = std::min( EDGE_BATCH, n-k );
+        unsigned int edge[EDGE_BATCH];
+        double a_axis[EDGE_BATCH], dist[EDGE_BATCH], t[EDGE_BATCH];
+        unsigned int N = 0;
+        for (unsigned int j=k; j<k+m; ++j) {
+            if ( isZero_tol( u1[j].z - u2[j].z ) ) {  // horizontal edge special case
+                contact[j] = CC_CLZ_Pair( 0 , u1[j].z - height(u1[j].y) );
+            } else { // the general offset-ellipse case
+                double theta = atan( (u2[j].z - u1[j].z) / (u2[j].x-u1[j].x) ); // theta is the slope of the line
+                edge[N] = j;
+                a_axis[N] = fabs( radius2/sin(theta) );  // long axis of ellipse = radius2/sin(theta)
+                dist[N] = u1[j].y;
+                ++N;
+            }
+        }
+        // short axis of ellipse = radius2, radius1 is the ellipse-offset
+        OffsetEllipseSolver( radius2, radius1 ).solve( N, a_axis, dist, t );
+        for (unsigned int i=0; i<N; ++i) {
+            const unsigned int j = edge[i];
+            Point ellcenter(0,u1[j].y,0);
+            Ellipse e = Ellipse( ellcenter, a_axis[i], radius2, radius1);
+            e.setSolution( t[i] );
+            e.setEllipsePositionHi(u1[j],u2[j]); // this selects either EllipsePosition1 or 
+            Point ell_ccp = e.ePointHi();
+            assert( fabs( ell_ccp.xyNorm() - radius1 ) < 1E-5); // ell_ccp should be on the cylinder-circle  
+            Point cc_tmp_u = ell_ccp.closestPoint(u1[j],u2[j]); // find cc-point on u1-u2 edge
+            contact[j] = CC_CLZ_Pair( cc_tmp_u.x , e.getCenterZ()-radius2);
+        }
+    }
+}
+
+// the edges are collected, and their offset-ellipse problems solved together, BATCH at a time
+template <>
+bool DropKernel<BullCutter>::edgesDrop(CLPoint& cl, unsigned int n, const Point* p1, const Point* p2) const {
+    static const unsigned int BATCH = 8;
+    bool result = false;
+    for (unsigned int j=0; j<n; j+=BATCH) {
+        const unsigned int N = std::min( BATCH, n-j );
+        unsigned int edge[BATCH];
+        Point sc[BATCH], vxy[BATCH], u1[BATCH], u2[BATCH];
+        CC_CLZ_Pair contact[BATCH];
+        unsigned int m = 0;
+        for (unsigned int k=j; k<j+N; ++k) {
+            if ( !isZero_tol( p1[k].x - p2[k].x) || !isZero_tol( p1[k].y - p2[k].y) ) {
+                const double d = cl.xyDistanceToLine(p1[k],p2[k]);
+                if (d<=c.radius) { // potential contact with edge, as in MillingCutter::singleEdgeDrop()
+                    Point v = p2[k] - p1[k];
+                    vxy[m] = Point( v.x, v.y, 0.0);
+                    vxy[m].xyNormalize();
+                    sc[m] = cl.xyClosestPoint( p1[k], p2[k] );
+                    assert( ( (cl-sc[m]).xyNorm() - d ) < 1E-6 );
+                    u1[m] = Point( (p1[k]-sc[m]).dot(vxy[m]) , d, p1[k].z);
+                    u2[m] = Point( (p2[k]-sc[m]).dot(vxy[m]) , d, p2[k].z);
+                    edge[m] = k;
+                    ++m;
+                }
+            }
+        }
+        c.BullCutter::edgeDropCanonical( m, u1, u2, contact );
+        for (unsigned int k=0; k<m; ++k) { // in edge order, as MillingCutter::edgeDrop()
+            CCPoint cc_tmp( sc[k] + contact[k].first * vxy[k], EDGE);
+            cc_tmp.z_projectOntoEdge(p1[edge[k]],p2[edge[k]]);
+            if ( cl.liftZ_if_InsidePoints( contact[k].second , cc_tmp , p1[edge[k]], p2[edge[k]]) )
+                result = true;
+        }
     }
+    return result;
 }
 
-// push-cutter: vertex and facet handled by base-class
-//  edge handled here
 bool BullCutter::generalEdgePush(const Fiber& f, Interval& i,  const Point& p1, const Point& p2) const {
     //std::cout << " BullCutter::generalEdgePush() \n";
     bool result = false;
@@ -165,5 +221,8 @@ std::ostream& operator<<(std::ostream &stream, BullCutter c) {
   return stream;
 }
 
+// the drop-cutter kernel, compiled here where height() and singleEdgeDropCanonical() can be inlined
+template class DropKernel<BullCutter>;
+
 } // end namespace
 // end file bullcutter.cpp
@@ -37,6 +37,8 @@ namespace ocl
 /// defined by the cutter diameter and by the corner radius
 ///
 class BullCutter : public MillingCutter {
+    template <class C> friend class DropKernel;
+
     public:
         BullCutter();
         /// Create bull-cutter with diamter d, corner radius r, and length l.
@@ -46,11 +48,18 @@ class BullCutter : public MillingCutter {
         /// string repr
         friend std::ostream& operator<<(std::ostream &stream, BullCutter c);
         std::string str() const;
+        /// the flat part of radius radius1 as a CylCutter, and the torus as a BallCutter of radius radius2
+        bool slopeBound(double& flat, double& round) const {flat = radius1; round = radius2; return true;}
         
     protected:
         
         bool generalEdgePush(const Fiber& f, Interval& i,  const Point& p1, const Point& p2) const;
         CC_CLZ_Pair singleEdgeDropCanonical(const Point& u1, const Point& u2) const;
+        /// singleEdgeDropCanonical() for n edges u1[k]-u2[k], writes the results to contact[k].
+        /// The offset-ellipse problems of the edges are solved together by an OffsetEllipseSolver.
+        /// singleEdgeDropCanonical() calls it with n=1, so the virtual and the DropKernel
+        /// paths give the same results.
+        void edgeDropCanonical(unsigned int n, const Point* u1, const Point* u2, CC_CLZ_Pair* contact) const;
         double height(double r) const;
         double width(double h) const; 
         /// radius of cylindrical part of cutter
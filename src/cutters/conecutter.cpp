@@ -26,6 +26,7 @@
 #include <boost/foreach.hpp>
 
 #include "conecutter.hpp"
+#include "dropkernel.hpp"
 #include "compositecutter.hpp" // for offsetCutter()
 #include "numeric.hpp"
 
@@ -330,5 +331,8 @@ std::ostream& operator<<(std::ostream &stream, ConeCutter c) {
   return stream;
 }
 
+// the drop-cutter kernel, compiled here where height() and singleEdgeDropCanonical() can be inlined
+template class DropKernel<ConeCutter>;
+
 } // end namespace
 // end file conecutter.cpp
@@ -35,6 +35,8 @@ namespace ocl
 /// cone defined by diameter and the cone half-angle(in radians). sharp tip. 
 /// 60 degrees or 90 degrees are common
 class ConeCutter : public MillingCutter {
+    template <class C> friend class DropKernel;
+
     public:
         ConeCutter();
         /// create a ConeCutter with specified maximum diameter and cone-angle
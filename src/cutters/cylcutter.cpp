@@ -26,6 +26,7 @@
 #include <boost/foreach.hpp>
 
 #include "cylcutter.hpp"
+#include "dropkernel.hpp"
 #include "bullcutter.hpp" // for offsetCutter()
 #include "numeric.hpp"
 
@@ -102,5 +103,8 @@ std::ostream& operator<<(std::ostream &stream, CylCutter c) {
   return stream;
 }
 
+// the drop-cutter kernel, compiled here where height() and singleEdgeDropCanonical() can be inlined
+template class DropKernel<CylCutter>;
+
 } // end namespace
 // end file cylcutter.cpp
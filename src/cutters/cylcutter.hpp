@@ -37,6 +37,8 @@ namespace ocl
 ///
 /// defined by one parameter, the cutter diameter
 class CylCutter : public MillingCutter {
+    template <class C> friend class DropKernel;
+
     public:
         CylCutter();
         /// create CylCutter with diameter d and length l
@@ -46,6 +48,8 @@ class CylCutter : public MillingCutter {
         /// string repr
         friend std::ostream& operator<<(std::ostream &stream, CylCutter c);        
         std::string str() const;
+        /// the flat bottom touches the plane at the rim, radius*g above the center
+        bool slopeBound(double& flat, double& round) const {flat = radius; round = 0.0; return true;}
     protected:
         bool vertexPush(const Fiber& f, Interval& i, const Triangle& t) const;
         CC_CLZ_Pair singleEdgeDropCanonical(const Point& u1, const Point& u2) const;
@@ -0,0 +1,171 @@
+/*  $Id$
+ * 
+ *  Copyright (c) 2010 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *  
+ *  This file is part of OpenCAMlib 
+ *  (see https://github.com/aewallin/opencamlib).
+ *  
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DROP_KERNEL_H
+#define DROP_KERNEL_H
+
+#include <typeinfo>
+
+#include "millingcutter.hpp"
+#include "cylcutter.hpp"
+#include "ballcutter.hpp"
+#include "bullcutter.hpp"
+#include "conecutter.hpp"
+#include "numeric.hpp"
+
+namespace ocl
+{
+
+///
+/// \brief MillingCutter::dropCutter() for one concrete cutter type C, without virtual calls
+///
+/// The member functions are the same as those of MillingCutter, with the calls to
+/// height(), facetDrop() and singleEdgeDropCanonical() qualified with C, so that they are
+/// resolved at compile-time and can be inlined. The results are the same as MillingCutter::dropCutter().
+/// Only for cutters that do not override vertexDrop() or edgeDrop(): the kernels of
+/// CylCutter, BallCutter, BullCutter and ConeCutter are compiled with the cutters,
+/// and cutterKind() selects one of them.
+template <class C>
+class DropKernel {
+    public:
+        /// a kernel for cutter c, which must outlive the kernel
+        explicit DropKernel(const C& cutter) : c(cutter) {}
+        /// drop the cutter at cl against triangle t, see MillingCutter::dropCutter()
+        bool dropCutter(CLPoint& cl, const Triangle& t) const;
+        /// drop against the facet of t, see MillingCutter::facetDrop()
+        bool facetDrop(CLPoint& cl, const Triangle& t) const {return c.C::facetDrop(cl,t);}
+        /// drop against the vertices of t, see MillingCutter::vertexDrop()
+        bool vertexDrop(CLPoint& cl, const Triangle& t) const;
+        /// drop against the single vertex p
+        bool pointDrop(CLPoint& cl, const Point& p) const;
+        /// drop against the edges of t, see MillingCutter::edgeDrop()
+        bool edgeDrop(CLPoint& cl, const Triangle& t) const;
+        /// drop against the n edges p1[k]-p2[k], in order. Same as edgeDrop() for each edge.
+        bool edgesDrop(CLPoint& cl, unsigned int n, const Point* p1, const Point* p2) const;
+    protected:
+        /// drop against edge p1-p2 at xy-distance d, see MillingCutter::singleEdgeDrop()
+        bool singleEdgeDrop(CLPoint& cl, const Point& p1, const Point& p2, double d) const;
+        /// the cutter
+        const C& c;
+};
+
+template <class C>
+bool DropKernel<C>::dropCutter(CLPoint& cl, const Triangle& t) const {
+    bool facet(false), vertex(false), edge(false);
+    if (cl.below(t)) {
+        facet = facetDrop(cl,t);
+        if (!facet) {
+            vertex = vertexDrop(cl,t);
+            if ( cl.below(t) ) {
+                edge = edgeDrop(cl,t); 
+            }
+        }
+    }
+    return ( facet || vertex || edge ); 
+}
+
+template <class C>
+bool DropKernel<C>::vertexDrop(CLPoint& cl, const Triangle& t) const {
+    bool result = false;
+    for (int n=0;n<3;n++) {
+        if ( pointDrop(cl, t.p[n]) )
+            result = true;
+    }
+    return result;
+}
+
+template <class C>
+bool DropKernel<C>::pointDrop(CLPoint& cl, const Point& p) const {
+    double q = cl.xyDistance(p);
+    if ( q <= c.radius ) {
+        CCPoint cc_tmp(p, VERTEX);
+        return cl.liftZ( p.z - c.C::height(q), cc_tmp );
+    }
+    return false;
+}
+
+template <class C>
+bool DropKernel<C>::edgeDrop(CLPoint& cl, const Triangle& t) const {
+    const Point p1[3] = { t.p[0], t.p[1], t.p[2] };
+    const Point p2[3] = { t.p[1], t.p[2], t.p[0] };
+    return edgesDrop(cl, 3, p1, p2);
+}
+
+template <class C>
+bool DropKernel<C>::edgesDrop(CLPoint& cl, unsigned int n, const Point* p1, const Point* p2) const {
+    bool result = false;
+    for (unsigned int k=0; k<n; ++k) {
+        if ( !isZero_tol( p1[k].x - p2[k].x) || !isZero_tol( p1[k].y - p2[k].y) ) {
+            const double d = cl.xyDistanceToLine(p1[k],p2[k]);
+            if (d<=c.radius)
+                if ( singleEdgeDrop(cl,p1[k],p2[k],d) )
+                    result=true;
+        }
+    }
+    return result;
+}
+
+template <class C>
+bool DropKernel<C>::singleEdgeDrop(CLPoint& cl, const Point& p1, const Point& p2, double d) const {
+    Point v = p2 - p1;
+    Point vxy( v.x, v.y, 0.0);
+    vxy.xyNormalize();
+    Point sc = cl.xyClosestPoint( p1, p2 );
+    assert( ( (cl-sc).xyNorm() - d ) < 1E-6 );
+    Point u1( (p1-sc).dot(vxy) , d, p1.z);
+    Point u2( (p2-sc).dot(vxy) , d, p2.z);
+    CC_CLZ_Pair contact = c.C::singleEdgeDropCanonical( u1, u2 );
+    CCPoint cc_tmp( sc + contact.first * vxy, EDGE);
+    cc_tmp.z_projectOntoEdge(p1,p2);
+    return cl.liftZ_if_InsidePoints( contact.second , cc_tmp , p1, p2);
+}
+
+/// BullCutter solves the offset-ellipses of the edges together, see BullCutter::edgeDropCanonical()
+template <>
+bool DropKernel<BullCutter>::edgesDrop(CLPoint& cl, unsigned int n, const Point* p1, const Point* p2) const;
+
+// compiled in the .cpp file of each cutter, where the cutter functions can be inlined
+extern template class DropKernel<CylCutter>;
+extern template class DropKernel<BallCutter>;
+extern template class DropKernel<BullCutter>;
+extern template class DropKernel<ConeCutter>;
+
+/// the cutter types that have a DropKernel
+enum CutterKind { OTHER_CUTTER, CYL_CUTTER, BALL_CUTTER, BULL_CUTTER, CONE_CUTTER };
+
+/// return the kind of cutter c, from its exact type. Classes derived from the four
+/// cutters may override the drop-cutter functions, so they are OTHER_CUTTER.
+inline CutterKind cutterKind(const MillingCutter& c) {
+    const std::type_info& type = typeid(c);
+    if ( type == typeid(CylCutter) )
+        return CYL_CUTTER;
+    else if ( type == typeid(BallCutter) )
+        return BALL_CUTTER;
+    else if ( type == typeid(BullCutter) )
+        return BULL_CUTTER;
+    else if ( type == typeid(ConeCutter) )
+        return CONE_CUTTER;
+    return OTHER_CUTTER;
+}
+
+} // end namespace
+#endif
+// end file dropkernel.hpp
@@ -207,6 +207,15 @@ int Ellipse::solver_brent() {
     return iters;
 }
 
+void Ellipse::setSolution(double t) {
+    const double s = sqrt( 1.0 - square(t) );
+    EllipsePosition1.s = s;
+    EllipsePosition1.t = t;
+    EllipsePosition1.diangle = xyVectorToDiangle( s, t);
+    EllipsePosition2.s = -s;
+    EllipsePosition2.t = t;
+    EllipsePosition2.diangle = xyVectorToDiangle(-s, t);
+}
 
 // used by BullCutter pushcutter edge-test
 bool AlignedEllipse::aligned_solver( const Fiber& f ) {
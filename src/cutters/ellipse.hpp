@@ -49,6 +49,9 @@ class Ellipse {
 
         /// offset-ellipse Brent solver
         int solver_brent();
+        /// set the two solutions to ( s, t ) and ( -s, t ), with s = sqrt(1-t^2). For a t from 
+        /// OffsetEllipseSolver, these are the solutions solver_brent() finds.
+        void setSolution(double t);
         /// print out the found solutions
         void print_solutions();
         /// given one EllipsePosition solution, find the other.
@@ -0,0 +1,264 @@
+/*  $Id$
+ * 
+ *  Copyright (c) 2010 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *  
+ *  This file is part of OpenCAMlib 
+ *  (see https://github.com/aewallin/opencamlib).
+ *  
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <cassert>
+
+#include "ellipsesolver.hpp"
+#include "brent_zero.hpp"
+
+// an AVX version of the Newton iteration, selected at runtime with the GCC/clang CPU-detection builtins,
+// as for TriangleStore::filter(). Other compilers and CPUs use the scalar version.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #define OCL_X86_SIMD
+    #include <immintrin.h>
+#endif
+
+namespace ocl
+{
+
+/// problems per Newton iteration call
+static const unsigned int LANES = 4;
+/// Newton iterations before a problem is handed to brent_zero()
+static const unsigned int NEWTON_MAX = 16;
+/// Newton's method has converged when the step is this small. t is in [-1, 0].
+static const double NEWTON_STEP = 1E-15;
+
+/// signature of the Newton iteration implementations. Solves LANES problems, writes the
+/// root to t, the number of iterations to iters, and false to converged where the iteration failed.
+typedef void (*NewtonFunction)(const double* a, const double* d, double b, double offset,
+                               double* t, unsigned int* iters, bool* converged);
+
+// the expressions are written in the same order as in newton_avx(), so that the results are identical
+static void newton_scalar(const double* a, const double* d, double b, double offset,
+                          double* t, unsigned int* iters, bool* converged) {
+    const double bb = b*b;
+    for (unsigned int k=0; k<LANES; ++k) {
+        const double aa = a[k]*a[k] - bb;
+        const double ca = offset*a[k];
+        // the tangent at t=0, and one fixed-point step t = -d/(b + ca/sqrt(q(t))). Both are right of the root.
+        const double t0 = -d[k] / ( b + ca/b );
+        double x = -d[k] / ( b + ca/std::sqrt( bb + aa*t0*t0 ) );
+        if ( x < -1.0 )
+            x = -1.0;
+        unsigned int n = 0;
+        bool done = false;
+        while ( !done && n < NEWTON_MAX ) {
+            const double q = bb + aa*x*x;
+            const double sq = std::sqrt(q);
+            const double f = d[k] + b*x + ca*x/sq;
+            const double fp = b + ca*bb/(q*sq);
+            const double step = f/fp;
+            x = x - step;
+            ++n;
+            done = ( std::fabs(step) <= NEWTON_STEP );
+        }
+        t[k] = x;
+        iters[k] = n;
+        converged[k] = done;
+    }
+}
+
+#ifdef OCL_X86_SIMD
+__attribute__((target("avx")))
+static void newton_avx(const double* a, const double* d, double b, double offset,
+                       double* t, unsigned int* iters, bool* converged) {
+    const __m256d vb    = _mm256_set1_pd(b);
+    const __m256d bb    = _mm256_set1_pd(b*b);
+    const __m256d one   = _mm256_set1_pd(1.0);
+    const __m256d sign  = _mm256_set1_pd(-0.0);
+    const __m256d tol   = _mm256_set1_pd(NEWTON_STEP);
+    const __m256d va = _mm256_loadu_pd(a);
+    const __m256d vd = _mm256_loadu_pd(d);
+    const __m256d nd = _mm256_xor_pd(vd, sign); // -d, also for d=0
+    const __m256d aa = _mm256_sub_pd( _mm256_mul_pd(va, va), bb );
+    const __m256d ca = _mm256_mul_pd( _mm256_set1_pd(offset), va );
+    const __m256d t0 = _mm256_div_pd( nd, _mm256_add_pd( vb, _mm256_div_pd(ca, vb) ) );
+    const __m256d q0 = _mm256_add_pd( bb, _mm256_mul_pd( _mm256_mul_pd(aa, t0), t0 ) );
+    __m256d x = _mm256_div_pd( nd, _mm256_add_pd( vb, _mm256_div_pd( ca, _mm256_sqrt_pd(q0) ) ) );
+    x = _mm256_max_pd( _mm256_set1_pd(-1.0), x ); // returns x if x is NaN, as the scalar compare
+    __m256d active = _mm256_castsi256_pd( _mm256_set1_epi64x(-1) );
+    __m256d count = _mm256_setzero_pd();
+    for (unsigned int n=0; n<NEWTON_MAX && _mm256_movemask_pd(active); ++n) {
+        const __m256d q = _mm256_add_pd( bb, _mm256_mul_pd( _mm256_mul_pd(aa, x), x ) );
+        const __m256d sq = _mm256_sqrt_pd(q);
+        const __m256d f = _mm256_add_pd( _mm256_add_pd( vd, _mm256_mul_pd(vb, x) ),
+                                         _mm256_div_pd( _mm256_mul_pd(ca, x), sq ) );
+        const __m256d fp = _mm256_add_pd( vb, _mm256_div_pd( _mm256_mul_pd(ca, bb), _mm256_mul_pd(q, sq) ) );
+        const __m256d step = _mm256_div_pd(f, fp);
+        // converged lanes keep their value
+        x = _mm256_blendv_pd( x, _mm256_sub_pd(x, step), active );
+        count = _mm256_add_pd( count, _mm256_and_pd(active, one) );
+        const __m256d done = _mm256_cmp_pd( _mm256_andnot_pd(sign, step), tol, _CMP_LE_OQ );
+        active = _mm256_andnot_pd( done, active );
+    }
+    _mm256_storeu_pd(t, x);
+    double c[LANES];
+    _mm256_storeu_pd(c, count);
+    const int failed = _mm256_movemask_pd(active);
+    for (unsigned int k=0; k<LANES; ++k) {
+        iters[k] = (unsigned int)c[k];
+        converged[k] = !( (failed >> k) & 1 );
+    }
+}
+#endif
+
+/// the Newton iteration for this CPU
+struct NewtonImplementation {
+    NewtonImplementation() : function(newton_scalar), name("scalar") {
+#ifdef OCL_X86_SIMD
+        __builtin_cpu_init();
+        if ( __builtin_cpu_supports("avx") ) {
+            function = newton_avx;
+            name = "avx";
+        }
+#endif
+    }
+    /// the selected function
+    NewtonFunction function;
+    /// name of the selected function
+    const char* name;
+};
+
+/// return the Newton iteration implementation, selected on the first call
+static const NewtonImplementation& newton_implementation() {
+    static const NewtonImplementation impl;
+    return impl;
+}
+
+/// the error-function f(t) of one problem, for brent_zero()
+class OffsetEllipseError {
+    public:
+        OffsetEllipseError(double ain, double bin, double ofs, double din) 
+            : a(ain), b(bin), offset(ofs), d(din), evaluations(0) {}
+        /// f(t), see OffsetEllipseSolver
+        double error(double t) {
+            ++evaluations;
+            return d + b*t + offset*a*t/std::sqrt( b*b + (a*a-b*b)*t*t );
+        }
+        /// major axis
+        double a;
+        /// minor axis
+        double b;
+        /// offset distance
+        double offset;
+        /// center distance
+        double d;
+        /// number of error() calls
+        unsigned long evaluations;
+};
+
+/// true if solve() updates the counters, see OffsetEllipseSolver::setCollectStats()
+static std::atomic<bool> stat_collect(false);
+/// the counters of OffsetEllipseSolver::getStats()
+static std::atomic<unsigned long> stat_solves(0);
+/// Newton iterations
+static std::atomic<unsigned long> stat_newton(0);
+/// maximum Newton iterations
+static std::atomic<unsigned long> stat_newton_max(0);
+/// brent_zero() fallbacks
+static std::atomic<unsigned long> stat_brent(0);
+/// brent_zero() error-function evaluations
+static std::atomic<unsigned long> stat_brent_evals(0);
+
+OffsetEllipseSolver::OffsetEllipseSolver(double bin, double ofs) {
+    b = bin;        assert( b > 0.0 );
+    offset = ofs;   assert( offset >= 0.0 );
+}
+
+void OffsetEllipseSolver::solve(unsigned int n, const double* a, const double* d, double* t) const {
+    const NewtonFunction newton = newton_implementation().function;
+    unsigned long iterations = 0;
+    unsigned long maxIterations = 0;
+    unsigned long brents = 0;
+    unsigned long evaluations = 0;
+    for (unsigned int k=0; k<n; k+=LANES) {
+        const unsigned int m = std::min( LANES, n-k );
+        // unused lanes get a problem with the root at t=0
+        double la[LANES], ld[LANES], lt[LANES];
+        unsigned int li[LANES];
+        bool ok[LANES];
+        for (unsigned int j=0; j<LANES; ++j) {
+            la[j] = ( j<m ) ? a[k+j] : b;
+            ld[j] = ( j<m ) ? d[k+j] : 0.0;
+        }
+        newton( la, ld, b, offset, lt, li, ok );
+        for (unsigned int j=0; j<m; ++j) {
+            iterations += li[j];
+            maxIterations = std::max( maxIterations, (unsigned long)li[j] );
+            if ( !ok[j] || !( lt[j] >= -1.0 && lt[j] <= 0.0 ) ) {
+                OffsetEllipseError f( la[j], b, offset, ld[j] );
+                const double f0 = f.error(0.0);
+                const double f1 = f.error(-1.0);
+                if ( f0 <= 0.0 )
+                    lt[j] = 0.0;
+                else if ( f1 >= 0.0 )
+                    lt[j] = -1.0;
+                else
+                    lt[j] = brent_zero( -1.0, 0.0, 3E-16, NEWTON_STEP, &f );
+                ++brents;
+                evaluations += f.evaluations;
+            }
+            t[k+j] = lt[j];
+        }
+    }
+    // the counters are shared by all threads, so they are only written when asked for
+    if ( !stat_collect.load( std::memory_order_relaxed ) )
+        return;
+    stat_solves += n;
+    stat_newton += iterations;
+    stat_brent += brents;
+    stat_brent_evals += evaluations;
+    unsigned long previous = stat_newton_max.load();
+    while ( previous < maxIterations && !stat_newton_max.compare_exchange_weak( previous, maxIterations ) ) {}
+}
+
+void OffsetEllipseSolver::setCollectStats(bool on) {
+    stat_collect = on;
+}
+
+EllipseSolverStats OffsetEllipseSolver::getStats() {
+    EllipseSolverStats s;
+    s.solves = stat_solves.load();
+    s.newtonIterations = stat_newton.load();
+    s.maxNewtonIterations = stat_newton_max.load();
+    s.brentSolves = stat_brent.load();
+    s.brentEvaluations = stat_brent_evals.load();
+    return s;
+}
+
+void OffsetEllipseSolver::resetStats() {
+    stat_solves = 0;
+    stat_newton = 0;
+    stat_newton_max = 0;
+    stat_brent = 0;
+    stat_brent_evals = 0;
+}
+
+std::string OffsetEllipseSolver::solverType() {
+    return newton_implementation().name;
+}
+
+} // end namespace
+// end file ellipsesolver.cpp
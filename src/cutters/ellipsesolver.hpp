@@ -0,0 +1,85 @@
+/*  $Id$
+ * 
+ *  Copyright (c) 2010 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *  
+ *  This file is part of OpenCAMlib 
+ *  (see https://github.com/aewallin/opencamlib).
+ *  
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef ELLIPSE_SOLVER_H
+#define ELLIPSE_SOLVER_H
+
+#include <string>
+
+namespace ocl
+{
+
+/// iteration counts of OffsetEllipseSolver::solve() calls, see OffsetEllipseSolver::getStats()
+struct EllipseSolverStats {
+    /// number of problems solved
+    unsigned long solves;
+    /// Newton iterations, summed over all problems
+    unsigned long newtonIterations;
+    /// the most Newton iterations any one problem needed
+    unsigned long maxNewtonIterations;
+    /// number of problems where Newton's method did not converge, solved with brent_zero()
+    unsigned long brentSolves;
+    /// error-function evaluations of the brent_zero() fallbacks
+    unsigned long brentEvaluations;
+};
+
+///
+/// \brief batched solver for the offset-ellipse of BullCutter edge-drop
+///
+/// In the canonical edge-drop position (see MillingCutter::singleEdgeDropCanonical()) the
+/// torus of the BullCutter cuts the plane through the edge in an ellipse with axes a and b,
+/// centered at y=d. The contact is where the offset-ellipse point, at distance offset from the
+/// ellipse along its normal, is at y=0. At the ellipse position (s,t) this y-coordinate is
+///     f(t) = d + b*t + offset*a*t / sqrt( b^2 + (a^2-b^2)*t^2 )
+/// which increases with t and is convex for t<0. With 0 <= d <= b+offset there is one
+/// root in [-1, 0], and this is what solve() finds.
+///
+/// The Newton iteration starts to the right of the root, from the tangent at t=0 improved by one
+/// fixed-point step, and then approaches the root from the right without overshooting.
+/// It usually converges in three to five iterations. Problems where it does not are solved
+/// with brent_zero() on [-1, 0]. The problems are solved four at a time with AVX when the CPU has it,
+/// with the same results as the scalar version.
+class OffsetEllipseSolver {
+    public:
+        /// a solver for ellipses with minor axis b and offset distance offset
+        OffsetEllipseSolver(double b, double offset);
+        /// solve n problems: problem k has major axis a[k] >= b, and center distance d[k].
+        /// Writes the root t of f() to t[k], the ellipse position is ( +/-sqrt(1-t^2), t ).
+        void solve(unsigned int n, const double* a, const double* d, double* t) const;
+        /// return the iteration counts of the solve() calls since the last resetStats(), from all threads.
+        /// Only calls made while setCollectStats(true) is in effect are counted.
+        static EllipseSolverStats getStats();
+        /// turn counting for getStats() on or off. Off by default, since the counters are
+        /// shared by all threads and solve() is on the edge-drop hot path.
+        static void setCollectStats(bool on);
+        /// set the iteration counts to zero
+        static void resetStats();
+        /// return the name of the solve() implementation in use: "avx" or "scalar"
+        static std::string solverType();
+    private:
+        /// minor axis of the ellipses
+        double b;
+        /// offset distance
+        double offset;
+};
+
+} // end namespace
+#endif
+// end file ellipsesolver.hpp
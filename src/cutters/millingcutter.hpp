@@ -25,6 +25,7 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <cassert>
 
 #include "stlsurf.hpp"
 #include "fiber.hpp"
@@ -37,6 +38,7 @@ namespace ocl
 
 class Triangle;
 class STLSurf;
+template <class C> class DropKernel;
 
 // CC_CLZ_Pair is the return type of 
 // CC is the x-coordinate of the cutter-contact point
@@ -49,6 +51,7 @@ typedef std::pair< double, double > DoublePair;
 ///
 class MillingCutter {
     friend class CompositeCutter;
+    friend class HeightmapDropCutter;
 
     public:
         /// default constructor
@@ -103,6 +106,13 @@ class MillingCutter {
         /// Return true if contact was made with the Triangle
         bool pushCutter(const Fiber& f, Interval& i, const Triangle& t) const;
         
+        /// \brief coefficients of an upper bound for dropCutter() against a sloping plane.
+        /// With g the slope of the plane, no point of the plane under the cutter at cl
+        /// gives a cl.z above the height of the plane at (cl.x, cl.y) + flat*g + round*(sqrt(1+g*g)-1).
+        /// Returns false if the cutter does not have such a bound, which is the default.
+        /// BatchDropCutter uses this to skip the triangles that cannot lift cl.
+        virtual bool slopeBound(double& flat, double& round) const {return false;}
+        
         /// return a string representation of the MillingCutter
         virtual std::string str() const {return "MillingCutter (all derived classes should override this)";}
         
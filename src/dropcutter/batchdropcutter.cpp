@@ -19,6 +19,11 @@
  *  along with this program. If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <numeric>
+
 #include <boost/foreach.hpp>
 #include <boost/progress.hpp>
 
@@ -38,27 +43,29 @@ namespace ocl
 BatchDropCutter::BatchDropCutter() {
     clpoints = new std::vector<CLPoint>();
     nCalls = 0;
-#ifdef _OPENMP
-    nthreads = omp_get_num_procs(); // figure out how many cores we have
-#endif
     cutter = NULL;
     bucketSize = 1;
-    root = new KDTree<Triangle>();
+    zSort = false;
+    tileSize = 0;
+    chunkSize = 10000;
+    kind = OTHER_CUTTER;
+    uniqueEdges = false;
 }
 
 BatchDropCutter::~BatchDropCutter() { 
     clpoints->clear();
     delete clpoints;
-    delete root;
 }
  
 void BatchDropCutter::setSTL(const STLSurf &s) {
     std::cout << "bdc::setSTL()\n";
     surf = &s;
-    root->setXYDimensions(); // we search for triangles in the XY plane, don't care about Z-coordinate
-    root->setBucketSize( bucketSize );
-    root->build(s.tris);
-    std::cout << "bdc::setSTL() done.\n";
+    SpatialIndex<Triangle>* index = newIndex();
+    index->setXYDimensions(); // we search for triangles in the XY plane, don't care about Z-coordinate
+    index->setBucketSize( bucketSize );
+    root = s.indexCache.get( indexType, index, s.tris ); // built here, or shared with earlier operations
+    store = s.getStore();
+    std::cout << "bdc::setSTL() done. " << root->str() << "\n";
 }
 
 
@@ -89,14 +96,13 @@ void BatchDropCutter::dropCutter2() {
             " cl-points and " << surf->tris.size() << " triangles.\n";
     std::cout.flush();
     nCalls = 0;
-    std::list<Triangle> *triangles_under_cutter;
+    std::vector<const Triangle*> triangles_under_cutter;
     BOOST_FOREACH(CLPoint &cl, *clpoints) { //loop through each CL-point
-        triangles_under_cutter = root->search_cutter_overlap( cutter , &cl);
-        BOOST_FOREACH( const Triangle& t, *triangles_under_cutter) {
-            cutter->dropCutter(cl,t);
+        root->search_cutter_overlap( cutter , &cl, triangles_under_cutter );
+        BOOST_FOREACH( const Triangle* t, triangles_under_cutter) {
+            cutter->dropCutter(cl,*t);
             ++nCalls;
         }
-        delete triangles_under_cutter;
     }
     
     std::cout << "done. " << nCalls << " dropCutter() calls.\n";
@@ -110,19 +116,18 @@ void BatchDropCutter::dropCutter3() {
             " cl-points and " << surf->tris.size() << " triangles.\n";
     nCalls = 0;
     boost::progress_display show_progress( clpoints->size() );
-    std::list<Triangle> *triangles_under_cutter;
+    std::vector<const Triangle*> triangles_under_cutter;
     BOOST_FOREACH(CLPoint &cl, *clpoints) { //loop through each CL-point
-        triangles_under_cutter = root->search_cutter_overlap( cutter , &cl);
-        BOOST_FOREACH( const Triangle& t, *triangles_under_cutter) {
-            if (cutter->overlaps(cl,t)) {
-                if ( cl.below(t) ) {
-                    cutter->dropCutter(cl,t);
+        root->search_cutter_overlap( cutter , &cl, triangles_under_cutter );
+        BOOST_FOREACH( const Triangle* t, triangles_under_cutter) {
+            if (cutter->overlaps(cl,*t)) {
+                if ( cl.below(*t) ) {
+                    cutter->dropCutter(cl,*t);
                     ++nCalls;
                 }
             }
         }
         ++show_progress;
-        delete triangles_under_cutter;
     }
     
     std::cout << "done. " << nCalls << " dropCutter() calls.\n";
@@ -137,7 +142,6 @@ void BatchDropCutter::dropCutter4() {
     nCalls = 0;
     int calls=0;
     long int ntris = 0;
-    std::list<Triangle>* tris;
 #ifdef _WIN32 // OpenMP version 2 of VS2013 OpenMP need signed loop variable
 	int n; // loop variable
     int Nmax = clpoints->size();
@@ -151,8 +155,11 @@ void BatchDropCutter::dropCutter4() {
     omp_set_num_threads(nthreads); // the constructor sets number of threads right
                                    // or the user can explicitly specify something else
 #endif
-    std::list<Triangle>::iterator it;
-    #pragma omp parallel for shared( nloop, ntris, calls, clref) private(n,tris,it)
+    #pragma omp parallel shared( nloop, ntris, calls, clref)
+    {
+    std::vector<const Triangle*> tris; // search results, re-used for all cl-points of this thread
+    std::vector<const Triangle*>::iterator it;
+    #pragma omp for
         for (n=0;n< Nmax ;n++) { // PARALLEL OpenMP loop!
 #ifdef _OPENMP
             if ( n== 0 ) { // first iteration
@@ -161,88 +168,363 @@ void BatchDropCutter::dropCutter4() {
             }
 #endif
             nloop++;
-            tris = root->search_cutter_overlap( cutter, &clref[n] );
-            // assert( tris->size() <= ntriangles ); // can't possibly find more triangles than in the STLSurf 
-            for( it=tris->begin(); it!=tris->end() ; ++it) { // loop over found triangles  
-                if ( cutter->overlaps(clref[n],*it) ) { // cutter overlap triangle? check
-                    if (clref[n].below(*it)) {
-                        cutter->vertexDrop( clref[n],*it);
+            root->search_cutter_overlap( cutter, &clref[n], tris );
+            // assert( tris.size() <= ntriangles ); // can't possibly find more triangles than in the STLSurf 
+            for( it=tris.begin(); it!=tris.end() ; ++it) { // loop over found triangles  
+                if ( cutter->overlaps(clref[n],**it) ) { // cutter overlap triangle? check
+                    if (clref[n].below(**it)) {
+                        cutter->vertexDrop( clref[n],**it);
                         ++calls;
                     }
                 }
             }
-            for( it=tris->begin(); it!=tris->end() ; ++it) { // loop over found triangles  
-                if ( cutter->overlaps(clref[n],*it) ) { // cutter overlap triangle? check
-                    if (clref[n].below(*it))
-                        cutter->facetDrop( clref[n],*it);
+            for( it=tris.begin(); it!=tris.end() ; ++it) { // loop over found triangles  
+                if ( cutter->overlaps(clref[n],**it) ) { // cutter overlap triangle? check
+                    if (clref[n].below(**it))
+                        cutter->facetDrop( clref[n],**it);
                 }
             }
-            for( it=tris->begin(); it!=tris->end() ; ++it) { // loop over found triangles  
-                if ( cutter->overlaps(clref[n],*it) ) { // cutter overlap triangle? check
-                    if (clref[n].below(*it))
-                        cutter->edgeDrop( clref[n],*it);
+            for( it=tris.begin(); it!=tris.end() ; ++it) { // loop over found triangles  
+                if ( cutter->overlaps(clref[n],**it) ) { // cutter overlap triangle? check
+                    if (clref[n].below(**it))
+                        cutter->edgeDrop( clref[n],**it);
                 }
             }
-            ntris += tris->size();
-            delete( tris );
+            ntris += tris.size();
             ++show_progress;
         } // end OpenMP PARALLEL for
+    }
     nCalls = calls;
     std::cout << " " << nCalls << " dropCutter() calls.\n";
     return;
 }
 
-// use OpenMP to share work between threads
+/// heap-order for triangle indices, on TriangleStore::maxz. Ties go to the lower index.
+class MaxZCompare {
+    public:
+        MaxZCompare(const std::vector<double>& z) : maxz(z) {}
+        /// true if triangle a comes after triangle b
+        bool operator()(unsigned int a, unsigned int b) const {
+            if ( maxz[a] != maxz[b] )
+                return maxz[a] < maxz[b];
+            return a > b;
+        }
+    private:
+        const std::vector<double>& maxz;
+};
+
+int BatchDropCutter::dropCutterTriangles(CLPoint& cl, const std::vector<unsigned int>& tris, DropScratch& s) const {
+    const TriangleStore& ts = *store;
+    const double r = cutter->getRadius();
+    std::vector<unsigned int>& hits = s.hits;
+    std::vector<float>& bounds = s.bounds;
+    // MillingCutter::overlaps() and CLPoint::below() for all found triangles at once
+    ts.filter( tris, cl.x-r, cl.x+r, cl.y-r, cl.y+r, cl.z, hits );
+    double flat, round;
+    const bool bounded = cutter->slopeBound( flat, round );
+    if (bounded) {
+        // drop-cutter only lifts cl.z, so a triangle whose bound is not above cl.z can be skipped.
+        // The skipped triangles would not have changed cl, and the result is the same.
+        ts.liftBounds( hits, cl.x, cl.y, r, flat, round, bounds );
+        unsigned int m = 0;
+        for (unsigned int k=0; k<hits.size(); ++k) {
+            hits[m] = hits[k];
+            bounds[m] = bounds[k];
+            m += ( cl.z < bounds[k] );
+        }
+        hits.resize(m);
+        bounds.resize(m);
+    }
+    // the switch is per cl-point, the loop over the triangles is compiled for each cutter
+    switch (kind) {
+        case CYL_CUTTER: {
+            DropKernel<CylCutter> drop( static_cast<const CylCutter&>(*cutter) );
+            return uniqueEdges ? dropUnique( drop, cl, s, bounded ) : dropHits( drop, cl, s, bounded );
+        }
+        case BALL_CUTTER: {
+            DropKernel<BallCutter> drop( static_cast<const BallCutter&>(*cutter) );
+            return uniqueEdges ? dropUnique( drop, cl, s, bounded ) : dropHits( drop, cl, s, bounded );
+        }
+        case BULL_CUTTER: {
+            DropKernel<BullCutter> drop( static_cast<const BullCutter&>(*cutter) );
+            return uniqueEdges ? dropUnique( drop, cl, s, bounded ) : dropHits( drop, cl, s, bounded );
+        }
+        case CONE_CUTTER: {
+            DropKernel<ConeCutter> drop( static_cast<const ConeCutter&>(*cutter) );
+            return uniqueEdges ? dropUnique( drop, cl, s, bounded ) : dropHits( drop, cl, s, bounded );
+        }
+        default:
+            return dropHits( *cutter, cl, s, bounded );
+    }
+}
+
+template <class Kernel>
+int BatchDropCutter::dropHits(const Kernel& drop, CLPoint& cl, DropScratch& s, bool bounded) const {
+    const TriangleStore& ts = *store;
+    std::vector<unsigned int>& hits = s.hits;
+    int calls = 0;
+    if (zSort) {
+        // a max-heap on bb.maxpt.z. Drop-cutter only lifts cl.z, so once cl.z is above the
+        // highest remaining triangle none of the rest can lift it.
+        MaxZCompare higher( ts.maxz );
+        std::make_heap( hits.begin(), hits.end(), higher );
+        std::vector<unsigned int>::iterator end = hits.end();
+        while ( end != hits.begin() && cl.z < ts.maxz[ hits.front() ] ) {
+            unsigned int i = hits.front();
+            std::pop_heap( hits.begin(), end, higher );
+            --end;
+            drop.dropCutter( cl, ts.triangle(i) );
+            ++calls;
+        }
+    } else {
+        for (unsigned int k=0; k<hits.size(); ++k) {
+            unsigned int i = hits[k];
+            // cl.z may have been lifted by an earlier triangle
+            if ( cl.z < ts.maxz[i] && ( !bounded || cl.z < s.bounds[k] ) ) {
+                drop.dropCutter( cl, ts.triangle(i) );
+                ++calls;
+            }
+        }
+    }
+    return calls;
+}
+
+// as dropHits(), except that the vertices and edges shared by the triangles are tested only the
+// first time they are reached. A vertex or edge already tested can not lift cl again, as cl.z only grows.
+template <class Kernel>
+int BatchDropCutter::dropUnique(const Kernel& drop, CLPoint& cl, DropScratch& s, bool bounded) const {
+    const TriangleStore& ts = *store;
+    const IndexedMesh& mesh = *ts.mesh;
+    const std::vector<unsigned int>& hits = s.hits;
+    // a flag per vertex and edge of the surface. The flags set are listed, and cleared at the end.
+    if ( s.vertexTested.size() != mesh.vertices.size() || s.edgeTested.size() != mesh.edges.size() ) {
+        s.vertexTested.assign( mesh.vertices.size(), false );
+        s.edgeTested.assign( mesh.edges.size(), false );
+    }
+    int calls = 0;
+    for (unsigned int k=0; k<hits.size(); ++k) {
+        unsigned int i = hits[k];
+        if ( !( cl.z < ts.maxz[i] && ( !bounded || cl.z < s.bounds[k] ) ) )
+            continue;
+        ++calls;
+        // as DropKernel::dropCutter()
+        const Triangle& t = ts.triangle(i);
+        if ( drop.facetDrop( cl, t ) )
+            continue;
+        for (int n=0; n<3; ++n) {
+            const unsigned int v = mesh.triangles[3*i+n];
+            if ( !s.vertexTested[v] ) {
+                s.vertexTested[v] = true;
+                s.vertices.push_back(v);
+                if ( cl.z < mesh.vertices[v].z )
+                    drop.pointDrop( cl, mesh.vertices[v] );
+            }
+        }
+        if ( !( cl.z < ts.maxz[i] ) )
+            continue;
+        Point p1[3], p2[3];
+        unsigned int N = 0;
+        for (int n=0; n<3; ++n) {
+            const unsigned int e = mesh.triangleEdges[3*i+n];
+            if ( !s.edgeTested[e] ) {
+                s.edgeTested[e] = true;
+                s.edges.push_back(e);
+                const Point& q1 = mesh.vertices[ mesh.edges[e].v[0] ];
+                const Point& q2 = mesh.vertices[ mesh.edges[e].v[1] ];
+                if ( cl.z < std::max( q1.z, q2.z ) ) {
+                    p1[N] = q1;
+                    p2[N] = q2;
+                    ++N;
+                }
+            }
+        }
+        if ( N > 0 )
+            drop.edgesDrop( cl, N, p1, p2 );
+    }
+    BOOST_FOREACH( unsigned int v, s.vertices )
+        s.vertexTested[v] = false;
+    BOOST_FOREACH( unsigned int e, s.edges )
+        s.edgeTested[e] = false;
+    s.vertices.clear();
+    s.edges.clear();
+    return calls;
+}
+
+/// number of cl-points per parallel_for() chunk
+static const unsigned int GRAIN = 16;
+
+// share work between the threads of the Executor
 void BatchDropCutter::dropCutter5() {
     std::cout << "dropCutterSTL5 " << clpoints->size() << 
-            " cl-points and " << surf->tris.size() << " triangles.\n";
+            " cl-points and " << surf->tris.size() << " triangles, " << TriangleStore::filterType() << " filter, " 
+            << TriangleStore::liftBoundsType() << " bounds.\n";
     boost::progress_display show_progress( clpoints->size() );
+    std::mutex progress; // guards show_progress
     nCalls = 0;
-    int calls=0;
-    long int ntris = 0;
-    std::list<Triangle>* tris;
-#ifdef _WIN32 // OpenMP version 2 of VS2013 OpenMP need signed loop variable
-    int Nmax = clpoints->size();
-	int n; // loop variable
-#else
-    unsigned int Nmax = clpoints->size();
-	unsigned int n; // loop variable
-#endif
+    kind = cutterKind( *cutter );
     std::vector<CLPoint>& clref = *clpoints; 
-    int nloop=0;
-    
-#ifdef _OPENMP
-    omp_set_num_threads(nthreads); // the constructor sets number of threads right
-                                   // or the user can explicitly specify something else
-#endif
-    std::list<Triangle>::iterator it;
-    #pragma omp parallel for schedule(dynamic) shared( nloop, ntris, calls, clref ) private(n,tris,it) 
-        for (n=0;n<Nmax;++n) { // PARALLEL OpenMP loop!
-#ifdef _OPENMP
-            if ( n== 0 ) { // first iteration
-                if (omp_get_thread_num() == 0 ) 
-                    std::cout << "Number of OpenMP threads = "<< omp_get_num_threads() << "\n";
+    Executor& ex = getExecutor();
+    std::cout << "Number of threads = " << ex.concurrency() << "\n";
+    // per-slot search results and call counts, re-used for all cl-points of the slot
+    std::vector< std::vector<unsigned int> > tris( ex.concurrency() );
+    std::vector<DropScratch> scratch( ex.concurrency() );
+    std::vector<int> calls( ex.concurrency(), 0 );
+    parallel_for( ex, clref.size(), GRAIN, [&](unsigned int begin, unsigned int end, unsigned int slot) {
+        for (unsigned int n=begin; n<end; ++n) {
+            root->search_cutter_overlap( cutter, &clref[n], tris[slot] );
+            calls[slot] += dropCutterTriangles( clref[n], tris[slot], scratch[slot] );
+        }
+        std::lock_guard<std::mutex> lock( progress );
+        show_progress += end-begin;
+    } );
+    nCalls = std::accumulate( calls.begin(), calls.end(), 0 );
+    std::cout << "\n " << nCalls << " dropCutter() calls.\n";
+    return;
+}
+
+/// interleave the bits of x and y, for sorting tiles in Morton (Z-curve) order
+static unsigned long long morton(unsigned int x, unsigned int y) {
+    unsigned long long m = 0;
+    for (int b=0; b<32; ++b) {
+        m |= ( (unsigned long long)( (x >> b) & 1 ) ) << (2*b);
+        m |= ( (unsigned long long)( (y >> b) & 1 ) ) << (2*b+1);
+    }
+    return m;
+}
+
+/// return the tile of a point at distance d from the grid origin, d/tileSize clamped to the
+/// range of unsigned int. The cast of a larger quotient is undefined; the far tiles share the last index.
+static unsigned int tileIndex(double d, double tileSize) {
+    const double q = d/tileSize;
+    const double qmax = (double)std::numeric_limits<unsigned int>::max();
+    return (unsigned int)( q < qmax ? q : qmax ); // NaN also goes to qmax
+}
+
+// one kd-tree search per tile of cl-points, tiles in Morton order
+void BatchDropCutter::dropCutter6() {
+    std::cout << "dropCutterSTL6 " << clpoints->size() << 
+            " cl-points and " << surf->tris.size() << " triangles, tileSize= " << tileSize << "\n";
+    nCalls = 0;
+    kind = cutterKind( *cutter );
+    std::vector<CLPoint>& clref = *clpoints; 
+    if ( clref.empty() )
+        return;
+    // sort the cl-points by tile, tiles in Morton order and points in input order within a tile
+    double xmin = clref[0].x;
+    double ymin = clref[0].y;
+    BOOST_FOREACH(const CLPoint& p, clref) {
+        xmin = std::min(xmin, p.x);
+        ymin = std::min(ymin, p.y);
+    }
+    std::vector< std::pair<unsigned long long, unsigned int> > order( clref.size() ); // (tile key, point)
+    for (unsigned int m=0; m<clref.size(); ++m) {
+        unsigned int ix = tileIndex( clref[m].x-xmin, tileSize );
+        unsigned int iy = tileIndex( clref[m].y-ymin, tileSize );
+        order[m] = std::make_pair( morton(ix, iy), m );
+    }
+    std::sort( order.begin(), order.end() );
+    std::vector<unsigned int> tiles; // tile t holds the points order[ tiles[t] ] to order[ tiles[t+1]-1 ]
+    for (unsigned int m=0; m<order.size(); ++m) {
+        if ( m==0 || order[m].first != order[m-1].first )
+            tiles.push_back(m);
+    }
+    tiles.push_back( order.size() );
+    const double r = cutter->getRadius();
+    Executor& ex = getExecutor();
+    std::vector< std::vector<unsigned int> > tris( ex.concurrency() ); // search results for the whole tile
+    std::vector<DropScratch> scratch( ex.concurrency() );
+    std::vector<int> calls( ex.concurrency(), 0 );
+    parallel_for( ex, tiles.size()-1, 1, [&](unsigned int begin, unsigned int end, unsigned int slot) {
+        for (unsigned int n=begin; n<end; ++n) {
+            // a bounding-box around the cutter at all points of the tile
+            const CLPoint& first = clref[ order[ tiles[n] ].second ];
+            double bxmin = first.x, bxmax = first.x;
+            double bymin = first.y, bymax = first.y;
+            double bzmin = first.z;
+            for (unsigned int m=tiles[n]; m<tiles[n+1]; ++m) {
+                const CLPoint& p = clref[ order[m].second ];
+                bxmin = std::min(bxmin, p.x);
+                bxmax = std::max(bxmax, p.x);
+                bymin = std::min(bymin, p.y);
+                bymax = std::max(bymax, p.y);
+                bzmin = std::min(bzmin, p.z);
             }
-#endif
-            nloop++;
-            tris = root->search_cutter_overlap( cutter, &clref[n] );
-            assert( tris );
-            // assert( tris->size() <= ntriangles ); // can't possibly find more triangles than in the STLSurf 
-            for( it=tris->begin(); it!=tris->end() ; ++it) { // loop over found triangles  
-                if ( cutter->overlaps(clref[n],*it) ) { // cutter overlap triangle? check
-                    if (clref[n].below(*it)) {
-                        cutter->dropCutter( clref[n],*it);
-                        ++calls;
-                    }
+            root->search( Bbox( bxmin-r, bxmax+r, bymin-r, bymax+r, bzmin, bzmin+cutter->getLength() ), tris[slot] );
+            // the search visits the tree in the same order for a tile as for a single point, so
+            // after filtering each point sees the same triangles in the same order as in dropCutter5()
+            for (unsigned int m=tiles[n]; m<tiles[n+1]; ++m)
+                calls[slot] += dropCutterTriangles( clref[ order[m].second ], tris[slot], scratch[slot] );
+        }
+    } );
+    nCalls = std::accumulate( calls.begin(), calls.end(), 0 );
+    std::cout << " " << nCalls << " dropCutter() calls.\n";
+}
+
+// as dropCutter5(), with one scratch CLPoint per slot
+void BatchDropCutter::runRecords(std::vector<CLRecord>& pts) {
+    std::cout << "dropCutterRecords " << pts.size() << 
+            " cl-points and " << surf->tris.size() << " triangles.\n";
+    nCalls = 0;
+    kind = cutterKind( *cutter );
+    Executor& ex = getExecutor();
+    std::vector<CLPoint> cl( ex.concurrency() ); // the point being dropped
+    std::vector< std::vector<unsigned int> > tris( ex.concurrency() );
+    std::vector<DropScratch> scratch( ex.concurrency() );
+    std::vector<int> calls( ex.concurrency(), 0 );
+    const CCPoint nocc;
+    parallel_for( ex, pts.size(), GRAIN, [&](unsigned int begin, unsigned int end, unsigned int slot) {
+        CLPoint& p = cl[slot];
+        for (unsigned int n=begin; n<end; ++n) {
+            p.x = pts[n].x;
+            p.y = pts[n].y;
+            p.z = pts[n].z;
+            *p.cc.load() = nocc;
+            root->search_cutter_overlap( cutter, &p, tris[slot] );
+            calls[slot] += dropCutterTriangles( p, tris[slot], scratch[slot] );
+            pts[n].set( p );
+        }
+    } );
+    nCalls = std::accumulate( calls.begin(), calls.end(), 0 );
+    std::cout << " " << nCalls << " dropCutter() calls.\n";
+}
+
+// read a window of chunks, drop them in parallel, deliver them in order, repeat
+void BatchDropCutter::runStream(CLPointSource source, CLPointSink sink) {
+    std::cout << "dropCutterStream " << surf->tris.size() << " triangles, chunkSize= " << chunkSize << "\n";
+    nCalls = 0;
+    kind = cutterKind( *cutter );
+    long int npoints = 0;
+    Executor& ex = getExecutor();
+    std::vector< std::vector<unsigned int> > tris( ex.concurrency() );
+    std::vector<DropScratch> scratch( ex.concurrency() );
+    std::vector<int> calls( ex.concurrency(), 0 );
+    // the chunks in memory. The vectors are re-used from one window to the next.
+    std::vector< std::vector<CLPoint> > window( 2*ex.concurrency() );
+    bool more = true;
+    while (more) {
+        // the source is called from this thread only
+        unsigned int Nmax = 0;
+        while ( more && Nmax < window.size() ) {
+            window[Nmax].clear();
+            more = source( window[Nmax], chunkSize );
+            if ( !window[Nmax].empty() )
+                ++Nmax;
+        }
+        parallel_for( ex, Nmax, 1, [&](unsigned int begin, unsigned int end, unsigned int slot) {
+            for (unsigned int n=begin; n<end; ++n) {
+                BOOST_FOREACH(CLPoint& cl, window[n]) {
+                    root->search_cutter_overlap( cutter, &cl, tris[slot] );
+                    calls[slot] += dropCutterTriangles( cl, tris[slot], scratch[slot] );
                 }
             }
-            ntris += tris->size();
-            delete( tris );
-            ++show_progress;
-        } // end OpenMP PARALLEL for
-    nCalls = calls;
-    std::cout << "\n " << nCalls << " dropCutter() calls.\n";
-    return;
+        } );
+        for (unsigned int n=0;n<Nmax;++n) {
+            sink( window[n] );
+            npoints += window[n].size();
+        }
+    }
+    nCalls = std::accumulate( calls.begin(), calls.end(), 0 );
+    std::cout << " " << npoints << " cl-points, " << nCalls << " dropCutter() calls.\n";
 }
 
 }// end namespace
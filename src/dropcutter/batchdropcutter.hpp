@@ -22,14 +22,20 @@
 #ifndef BDC_H
 #define BDC_H
 
+#include <stdexcept>
 #include <iostream>
 #include <string>
 #include <vector>
+#include <memory>
+#include <functional>
 
 #include "clpoint.hpp"
+#include "clrecord.hpp"
 #include "millingcutter.hpp"
+#include "dropkernel.hpp"
 #include "kdtree.hpp"
 #include "operation.hpp"
+#include "trianglestore.hpp"
 
 namespace ocl
 {
@@ -37,6 +43,11 @@ namespace ocl
 class STLSurf;
 class Triangle;
 
+/// input for BatchDropCutter::runStream(). Append at most n CL-points to chunk,
+/// and return false when there are no more points.
+typedef std::function< bool (std::vector<CLPoint>& chunk, unsigned int n) > CLPointSource;
+/// output of BatchDropCutter::runStream(), called with each finished chunk in input order
+typedef std::function< void (const std::vector<CLPoint>& chunk) > CLPointSink;
 
 ///
 /// BatchDropCutter takes a MillingCutter, an STLSurf, and a list of CLPoint's
@@ -54,14 +65,72 @@ class BatchDropCutter : public Operation {
         /// append to list of CL-points to evaluate
         void appendPoint(CLPoint& p);
         /// run drop-cutter on all clpoints
-        void run() {this->dropCutter5();};
+        void run() {
+            if (tileSize > 0)
+                this->dropCutter6();
+            else
+                this->dropCutter5();
+        };
+        /// run drop-cutter on points read from source in chunks, and pass the results to sink.
+        /// Up to two chunks per thread are in memory at a time, so memory does not grow with the
+        /// number of points. Chunks are processed in parallel, and sink gets them in input order.
+        /// The points appended with appendPoint() are not used, and getCLPoints() returns nothing.
+        void runStream(CLPointSource source, CLPointSink sink);
+        /// run drop-cutter on pts in place. Each thread drops its points with one re-used CLPoint,
+        /// so there is no CLPoint per input point. The points appended with appendPoint() are not used.
+        void runRecords(std::vector<CLRecord>& pts);
+        /// set the number of points per chunk of runStream(), at least one. With n=0 a
+        /// source can only return empty chunks, and runStream() would never finish, so
+        /// n=0 throws std::invalid_argument, a ValueError in Python.
+        void setChunkSize(unsigned int n) {
+            if ( n == 0 )
+                throw std::invalid_argument( "BatchDropCutter::setChunkSize(): the chunk size must be at least 1" );
+            chunkSize = n;
+        }
+        /// return the number of points per chunk of runStream()
+        unsigned int getChunkSize() const {return chunkSize;}
     // getters and setters
         /// return a vector of CLPoints, the result of this operation
         std::vector<CLPoint> getCLPoints() {return *clpoints;}
 		/// clears the vector of CLPoints
 		void clearCLPoints() {clpoints->clear();}
+        /// process the triangles under the cutter highest first, and stop when cl.z
+        /// is above all the remaining ones. This skips most of the exact drop-cutter tests.
+        /// The resulting cl.z is the same up to rounding in the last bit, and when two
+        /// triangles give the same cl.z the CCPoint may come from the other one.
+        void setZSort(bool b) {zSort = b;}
+        /// return true if triangles are processed highest first
+        bool getZSort() const {return zSort;}
+        /// group the cl-points in square tiles of side s in the XY-plane, and search the
+        /// kd-tree once per tile instead of once per point. Zero (the default) searches per point.
+        void setTileSize(double s) {tileSize = s;}
+        /// return the tile size, see setTileSize()
+        double getTileSize() const {return tileSize;}
+        /// test each vertex and edge of the triangles under the cutter only once per cl-point, from
+        /// the welded vertices and unique edges of STLSurf::getMesh(). Most edges are shared by two
+        /// triangles, and are otherwise tested twice. Only for cylinder, ball, bull and cone cutters,
+        /// and used instead of setZSort(). The resulting cl.z is the same up to rounding, and when
+        /// two triangles give the same cl.z the CCPoint may come from the other one.
+        void setUniqueEdges(bool b) {uniqueEdges = b;}
+        /// return true if vertices and edges are tested once per cl-point, see setUniqueEdges()
+        bool getUniqueEdges() const {return uniqueEdges;}
         
     protected:
+        /// work-vectors of dropCutterTriangles(), one per Executor slot, re-used for all cl-points of the slot
+        struct DropScratch {
+            /// the search results that pass the bounding-box tests
+            std::vector<unsigned int> hits;
+            /// the lift-bounds of the hits
+            std::vector<float> bounds;
+            /// true for the vertices of the IndexedMesh already tested, see dropUnique()
+            std::vector<bool> vertexTested;
+            /// true for the edges of the IndexedMesh already tested, see dropUnique()
+            std::vector<bool> edgeTested;
+            /// the vertices with vertexTested set
+            std::vector<unsigned int> vertices;
+            /// the edges with edgeTested set
+            std::vector<unsigned int> edges;
+        };
         /// unoptimized drop-cutter,  tests against all triangles of surface
         void dropCutter1();
         /// better, kd-tree optimized version      
@@ -70,11 +139,39 @@ class BatchDropCutter : public Operation {
         void dropCutter3();
         /// use OpenMP for multi-threading     
         void dropCutter4();
-        /// version 5 of the algorithm
+        /// version 5 of the algorithm, reads the triangle bounding-boxes from the TriangleStore
         void dropCutter5();
+        /// version 6, one search per tile of cl-points, tiles processed in Morton order
+        void dropCutter6();
+        /// drop cl against the triangles tris found by a search, return the number of 
+        /// MillingCutter::dropCutter() calls. s.hits holds the pre-filtered triangles,
+        /// and s.bounds their TriangleStore::liftBounds(). The exact drop-cutter runs only for
+        /// the triangles whose bound is above cl.z, when the cutter has a MillingCutter::slopeBound().
+        /// Cylinder, ball, bull and cone cutters are dropped with their DropKernel, the others
+        /// with the virtual MillingCutter::dropCutter().
+        int dropCutterTriangles(CLPoint& cl, const std::vector<unsigned int>& tris, DropScratch& s) const;
+        /// drop cl against the pre-filtered triangles s.hits with drop.dropCutter(), see dropCutterTriangles()
+        template <class Kernel>
+        int dropHits(const Kernel& drop, CLPoint& cl, DropScratch& s, bool bounded) const;
+        /// drop cl against the pre-filtered triangles s.hits as dropHits(), but test each of their
+        /// vertices and edges only once, see setUniqueEdges()
+        template <class Kernel>
+        int dropUnique(const Kernel& drop, CLPoint& cl, DropScratch& s, bool bounded) const;
     // DATA
         /// pointer to list of CL-points on which to run drop-cutter.
         std::vector<CLPoint>* clpoints;
+        /// the triangles of the STLSurf as arrays, see STLSurf::getStore()
+        std::shared_ptr<const TriangleStore> store;
+        /// process triangles highest first, see setZSort()
+        bool zSort;
+        /// side of the cl-point tiles of dropCutter6(), see setTileSize()
+        double tileSize;
+        /// number of points per chunk of runStream()
+        unsigned int chunkSize;
+        /// the DropKernel used by dropCutterTriangles(), set from the cutter at the start of each run
+        CutterKind kind;
+        /// test each vertex and edge once per cl-point, see setUniqueEdges()
+        bool uniqueEdges;
 
 };
 
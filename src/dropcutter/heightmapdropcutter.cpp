@@ -0,0 +1,288 @@
+/*  $Id$
+ *
+ *  Copyright (c) 2010 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *
+ *  This file is part of OpenCAMlib
+ *  (see https://github.com/aewallin/opencamlib).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <numeric>
+
+#include "heightmapdropcutter.hpp"
+#include "stlsurf.hpp"
+
+namespace ocl
+{
+
+/// raster rows handled together by rasterize(), one parallel_for() index each
+static const unsigned int BAND = 32;
+
+HeightmapDropCutter::HeightmapDropCutter() {
+    nCalls = 0;
+    cutter = NULL;
+    surf = NULL;
+    sampling = 0.1;
+    minimumZ = 0.0;
+    xmin = 0.0;
+    xmax = 0.0;
+    ymin = 0.0;
+    ymax = 0.0;
+    nx = 0;
+    ny = 0;
+    margin = 0;
+}
+
+void HeightmapDropCutter::setSTL(const STLSurf &s) {
+    surf = &s;
+    store = s.getStore();
+}
+
+void HeightmapDropCutter::setGrid(double x0, double x1, double y0, double y1) {
+    assert( x1 >= x0 && y1 >= y0 );
+    xmin = x0;
+    xmax = x1;
+    ymin = y0;
+    ymax = y1;
+}
+
+/// one tap of the dilation kernel: raster offset, and cutter height at that distance
+struct KernelTap {
+    /// offset in the raster
+    long offset;
+    /// MillingCutter::height() at the distance of the offset
+    double h;
+    /// xy-distance of the offset, squared, in raster steps
+    long d2;
+    /// lowest cutter first, then nearest first, then by offset. This is the order the
+    /// early exit in run() needs, and makes the result independent of the sort algorithm.
+    bool operator<(const KernelTap& o) const {
+        if ( h != o.h )
+            return h < o.h;
+        if ( d2 != o.d2 )
+            return d2 < o.d2;
+        return offset < o.offset;
+    }
+};
+
+void HeightmapDropCutter::run() {
+    const double s = sampling;
+    assert( s > 0.0 );
+    // the grid size follows the sampling at the time of the run, not of setGrid()
+    nx = (unsigned int)( (xmax-xmin)/s + 1E-9 ) + 1;
+    ny = (unsigned int)( (ymax-ymin)/s + 1E-9 ) + 1;
+    const double r = cutter->getRadius();
+    margin = (unsigned int)std::ceil( r/s );
+    const unsigned int rx = nx + 2*margin;
+    const unsigned int ry = ny + 2*margin;
+    std::cout << "HeightmapDropCutter " << nx << " x " << ny << " grid, raster " << rx << " x " << ry
+              << ", " << store->size() << " triangles.\n";
+    raster.assign( (std::size_t)rx*ry, -std::numeric_limits<double>::infinity() );
+    heights.assign( (std::size_t)nx*ny, minimumZ );
+
+    // the triangles are binned by the bands of rows they can reach, band b gets
+    // bandIds[ bandFirst[b] ] to bandIds[ bandFirst[b+1]-1 ], in the order of the store
+    const unsigned int nbands = (ry+BAND-1)/BAND;
+    const TriangleStore& ts = *store;
+    const double y0 = ymin - margin*s;
+    // the bands [b0, b1) whose rows rasterize() tests against triangle t, clamped before the cast
+    auto bands = [&](unsigned int t, unsigned int& b0, unsigned int& b1) {
+        const double lo = std::floor( (ts.miny[t]-y0)/(s*BAND) ) - 1.0;
+        const double hi = std::floor( ( (ts.maxy[t]-y0)/s + 1.0 )/BAND ) + 1.0;
+        b0 = (unsigned int)std::min( std::max( 0.0, lo ), (double)nbands );
+        b1 = (unsigned int)std::min( std::max( 0.0, hi ), (double)nbands );
+    };
+    std::vector<unsigned int> bandFirst( nbands+1, 0 );
+    for (unsigned int t=0; t<ts.size(); ++t) {
+        unsigned int b0, b1;
+        bands( t, b0, b1 );
+        for (unsigned int b=b0; b<b1; ++b)
+            bandFirst[b+1]++;
+    }
+    std::partial_sum( bandFirst.begin(), bandFirst.end(), bandFirst.begin() );
+    std::vector<unsigned int> bandIds( bandFirst.back() );
+    std::vector<unsigned int> fill( bandFirst.begin(), bandFirst.end()-1 );
+    for (unsigned int t=0; t<ts.size(); ++t) {
+        unsigned int b0, b1;
+        bands( t, b0, b1 );
+        for (unsigned int b=b0; b<b1; ++b)
+            bandIds[ fill[b]++ ] = t;
+    }
+
+    Executor& ex = getExecutor();
+    // each band of rows is written by one task only
+    parallel_for( ex, nbands, 1, [&](unsigned int begin, unsigned int end, unsigned int slot) {
+        for (unsigned int n=begin; n<end; ++n)
+            rasterize( n*BAND, std::min( (n+1)*BAND, ry ), bandIds.data() + bandFirst[n], bandFirst[n+1]-bandFirst[n] );
+    } );
+
+    // the dilation kernel: all raster offsets within the cutter radius
+    std::vector<KernelTap> kernel;
+    const int m = margin;
+    for (int dj=-m; dj<=m; ++dj) {
+        for (int di=-m; di<=m; ++di) {
+            long d2 = (long)di*di + (long)dj*dj;
+            double d = s*std::sqrt( (double)d2 );
+            if ( d <= r ) {
+                KernelTap tap;
+                tap.offset = (long)dj*rx + di;
+                tap.h = cutter->height(d);
+                tap.d2 = d2;
+                kernel.push_back(tap);
+            }
+        }
+    }
+    std::sort( kernel.begin(), kernel.end() );
+
+    // the highest raster point under the cutter bounds what any tap can give
+    std::vector<double> localmax;
+    neighbourhoodMax( ex, localmax );
+
+    std::vector<long> taps( ex.concurrency(), 0 );
+    const unsigned int K = kernel.size();
+    parallel_for( ex, ny, 1, [&](unsigned int begin, unsigned int end, unsigned int slot) {
+        for (unsigned int n=begin; n<end; ++n) {
+            for (unsigned int i=0; i<nx; ++i) {
+                const std::size_t c = (std::size_t)(n+margin)*rx + (i+margin);
+                const double top = localmax[c];
+                double best = minimumZ;
+                unsigned int k = 0;
+                // taps are in order of increasing h, so no later tap can reach above top - h
+                for ( ; k<K && best < top - kernel[k].h; ++k) {
+                    double z = raster[ c + kernel[k].offset ] - kernel[k].h;
+                    if ( z > best )
+                        best = z;
+                }
+                taps[slot] += k;
+                heights[ (std::size_t)n*nx + i ] = best;
+            }
+        }
+    } );
+    nCalls = nx*ny;
+    std::cout << " " << K << " kernel taps, " << std::accumulate( taps.begin(), taps.end(), 0L ) << " evaluated.\n";
+}
+
+// the facets are sampled at the raster points inside them. The edges are sampled at half the
+// raster step and moved to the nearest raster point, so that vertical walls and edges narrower
+// than the raster step are seen.
+void HeightmapDropCutter::rasterize(unsigned int jmin, unsigned int jmax, const unsigned int* ids, unsigned int n) {
+    const TriangleStore& ts = *store;
+    const double s = sampling;
+    const double x0 = xmin - margin*s;
+    const double y0 = ymin - margin*s;
+    const int rx = nx + 2*margin;
+    const double ylo = y0 + jmin*s - s;
+    const double yhi = y0 + (jmax-1)*s + s;
+    for (unsigned int m=0; m<n; ++m) {
+        const unsigned int t = ids[m];
+        if ( ts.maxy[t] < ylo || ts.miny[t] > yhi )
+            continue;
+        const double ax = ts.x[0][t], ay = ts.y[0][t], az = ts.z[0][t];
+        const double bx = ts.x[1][t], by = ts.y[1][t], bz = ts.z[1][t];
+        const double cx = ts.x[2][t], cy = ts.y[2][t], cz = ts.z[2][t];
+        // facet
+        const double det = (by-cy)*(ax-cx) + (cx-bx)*(ay-cy);
+        if ( std::fabs(det) > 1E-12 ) {
+            int i0 = std::max( (int)std::ceil( (ts.minx[t]-x0)/s ), 0 );
+            int i1 = std::min( (int)std::floor( (ts.maxx[t]-x0)/s ), rx-1 );
+            int j0 = std::max( (int)std::ceil( (ts.miny[t]-y0)/s ), (int)jmin );
+            int j1 = std::min( (int)std::floor( (ts.maxy[t]-y0)/s ), (int)jmax-1 );
+            for (int j=j0; j<=j1; ++j) {
+                const double py = y0 + j*s;
+                for (int i=i0; i<=i1; ++i) {
+                    const double px = x0 + i*s;
+                    const double l0 = ( (by-cy)*(px-cx) + (cx-bx)*(py-cy) ) / det;
+                    const double l1 = ( (cy-ay)*(px-cx) + (ax-cx)*(py-cy) ) / det;
+                    const double l2 = 1.0 - l0 - l1;
+                    if ( l0 < -1E-9 || l1 < -1E-9 || l2 < -1E-9 )
+                        continue;
+                    // clamped, steep facets have a small det
+                    double z = std::min( std::max( l0*az + l1*bz + l2*cz, ts.minz[t] ), ts.maxz[t] );
+                    double& zr = raster[ (std::size_t)j*rx + i ];
+                    if ( z > zr )
+                        zr = z;
+                }
+            }
+        }
+        // edges
+        for (int k=0; k<3; ++k) {
+            const int k1 = (k+1)%3;
+            const double px = ts.x[k][t], py = ts.y[k][t], pz = ts.z[k][t];
+            const double dx = ts.x[k1][t]-px, dy = ts.y[k1][t]-py, dz = ts.z[k1][t]-pz;
+            const unsigned int steps = (unsigned int)std::ceil( 2.0*std::sqrt(dx*dx+dy*dy)/s );
+            for (unsigned int q=0; q<=steps; ++q) {
+                const double f = ( steps == 0 ) ? 0.0 : (double)q/steps;
+                const long i = std::lround( (px+f*dx-x0)/s );
+                const long j = std::lround( (py+f*dy-y0)/s );
+                if ( i < 0 || i >= rx || j < (long)jmin || j >= (long)jmax )
+                    continue;
+                double& zr = raster[ (std::size_t)j*rx + i ];
+                if ( pz+f*dz > zr )
+                    zr = pz+f*dz;
+            }
+        }
+    }
+}
+
+/// out[i*stride] is the maximum of in[(i-w)*stride] to in[(i+w)*stride], clipped to [0, n)
+static void slidingMax(const double* in, double* out, int n, long stride, int w) {
+    std::deque<int> q; // indices of decreasing values, the front is the maximum of the window
+    for (int i=0; i<n+w; ++i) {
+        if ( i < n ) {
+            while ( !q.empty() && in[ q.back()*stride ] <= in[ i*stride ] )
+                q.pop_back();
+            q.push_back(i);
+        }
+        const int c = i-w; // the window of c is now complete
+        if ( c < 0 )
+            continue;
+        while ( q.front() < c-w )
+            q.pop_front();
+        out[ c*stride ] = in[ q.front()*stride ];
+    }
+}
+
+// separable, rows then columns, each O(1) per point
+void HeightmapDropCutter::neighbourhoodMax(Executor& ex, std::vector<double>& out) const {
+    const int rx = nx + 2*margin;
+    const int ry = ny + 2*margin;
+    std::vector<double> rows( raster.size() );
+    out.resize( raster.size() );
+    parallel_for( ex, ry, 16, [&](unsigned int begin, unsigned int end, unsigned int slot) {
+        for (unsigned int n=begin; n<end; ++n)
+            slidingMax( &raster[ (std::size_t)n*rx ], &rows[ (std::size_t)n*rx ], rx, 1, margin );
+    } );
+    parallel_for( ex, rx, 16, [&](unsigned int begin, unsigned int end, unsigned int slot) {
+        for (unsigned int n=begin; n<end; ++n)
+            slidingMax( &rows[n], &out[n], ry, rx, margin );
+    } );
+}
+
+std::vector<CLPoint> HeightmapDropCutter::getCLPoints() {
+    std::vector<CLPoint> clv;
+    clv.reserve( heights.size() );
+    for (unsigned int j=0; j<ny; ++j) {
+        for (unsigned int i=0; i<nx; ++i)
+            clv.push_back( CLPoint( xmin + i*sampling, ymin + j*sampling, heights[ (std::size_t)j*nx + i ] ) );
+    }
+    return clv;
+}
+
+} // end namespace
+// end file heightmapdropcutter.cpp
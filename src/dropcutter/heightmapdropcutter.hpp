@@ -0,0 +1,113 @@
+/*  $Id$
+ *
+ *  Copyright (c) 2010 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *
+ *  This file is part of OpenCAMlib
+ *  (see https://github.com/aewallin/opencamlib).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef HEIGHTMAPDROPCUTTER_H
+#define HEIGHTMAPDROPCUTTER_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "clpoint.hpp"
+#include "millingcutter.hpp"
+#include "operation.hpp"
+#include "trianglestore.hpp"
+
+namespace ocl
+{
+
+class STLSurf;
+
+///
+/// \brief drop-cutter on a rectangular XY-grid, computed on a height-map of the surface
+///
+/// HeightmapDropCutter samples the STLSurf on the grid into a height-map (a Z-buffer),
+/// and then dilates the height-map with the inverse of the cutter profile MillingCutter::height().
+/// The CL-height at grid point p is the maximum of z(q) - height(|p-q|) over the
+/// height-map samples q under the cutter. This works for all cutters that implement height(),
+/// including CompositeCutter, and costs one pass over the grid instead of one
+/// MillingCutter::dropCutter() call per point and triangle.
+///
+/// The result is exact only at the resolution of the grid: the surface is seen at the
+/// grid points, and edges and vertices are moved to the nearest grid point.
+/// The error is of the order of the sampling, use BatchDropCutter where that matters.
+class HeightmapDropCutter : public Operation {
+    public:
+        HeightmapDropCutter();
+        virtual ~HeightmapDropCutter() {}
+        /// set the STL-surface
+        void setSTL(const STLSurf &s);
+        /// set the grid to [xmin, xmax] x [ymin, ymax]. The grid points are
+        /// ( xmin + i*sampling, ymin + j*sampling ), with the sampling at the time of run(),
+        /// see setSampling().
+        void setGrid(double xmin, double xmax, double ymin, double ymax);
+        /// set the minimum z-value, or "floor", used where the cutter touches no triangle
+        void setZ(const double z) {minimumZ = z;}
+        /// return the minimum z-value
+        double getZ() const {return minimumZ;}
+        /// run drop-cutter on the grid
+        void run();
+        /// return the number of grid points in the x-direction, set by run()
+        unsigned int getXSize() const {return nx;}
+        /// return the number of grid points in the y-direction, set by run()
+        unsigned int getYSize() const {return ny;}
+        /// return the CL-heights, point (i,j) is at index j*getXSize()+i
+        const std::vector<double>& getHeights() const {return heights;}
+        /// return the grid points as CLPoints. The CCPoints are not computed.
+        std::vector<CLPoint> getCLPoints();
+        /// clear the result
+        void clearCLPoints() {heights.clear();}
+
+    protected:
+        /// sample the n triangles ids on the raster, rows [jmin, jmax) only
+        void rasterize(unsigned int jmin, unsigned int jmax, const unsigned int* ids, unsigned int n);
+        /// the maximum of the raster over the cutter-sized square around each raster point
+        void neighbourhoodMax(Executor& ex, std::vector<double>& out) const;
+    // DATA
+        /// the triangles of the STLSurf as arrays, see STLSurf::getStore()
+        std::shared_ptr<const TriangleStore> store;
+        /// the lowest z height, used when no triangles are touched
+        double minimumZ;
+        /// minimum x of the grid
+        double xmin;
+        /// maximum x of the grid, see setGrid()
+        double xmax;
+        /// minimum y of the grid
+        double ymin;
+        /// maximum y of the grid, see setGrid()
+        double ymax;
+        /// number of grid points in x, computed by run() from xmin, xmax and sampling
+        unsigned int nx;
+        /// number of grid points in y, computed by run()
+        unsigned int ny;
+        /// number of raster points outside the grid on each side, enough for the cutter radius
+        unsigned int margin;
+        /// the sampled surface, (nx+2*margin) x (ny+2*margin) points. -infinity where there is no triangle.
+        std::vector<double> raster;
+        /// the result, nx x ny CL-heights
+        std::vector<double> heights;
+};
+
+} // end namespace
+
+#endif
+// end file heightmapdropcutter.hpp
@@ -58,24 +58,25 @@ void PathDropCutter::run() {
 
 void PathDropCutter::uniform_sampling_run() {
     clpoints.clear();
+    samples.clear();
     BOOST_FOREACH( const Span* span, path->span_list ) { // loop through the spans calling run() on each
-        this->sample_span(span); // append points to bdc
+        this->sample_span(span); // append points to samples
+    }
+    ((BatchDropCutter*)(subOp[0]))->runRecords( samples );
+    clpoints.reserve( samples.size() );
+    BOOST_FOREACH( const CLRecord& r, samples ) {
+        clpoints.push_back( r.toCLPoint() );
     }
-    subOp[0]->run();
-    clpoints = subOp[0]->getCLPoints();
 }
 
-// this samples the Span and pushes the corresponding sampled points to bdc
+// this samples the Span and pushes the corresponding sampled points to samples
 void PathDropCutter::sample_span(const Span* span) {
     assert( sampling > 0.0 );
     unsigned int num_steps = (unsigned int)(span->length2d() / sampling + 1);
     for(unsigned int i = 0; i<=num_steps; i++) {
         double fraction = (double)i / num_steps;
         Point ptmp = span->getPoint(fraction);
-        CLPoint* p = new CLPoint(ptmp.x, ptmp.y, ptmp.z);
-        p->z = minimumZ;
-        subOp[0]->appendPoint( *p );
-        delete p;
+        samples.push_back( CLRecord(ptmp.x, ptmp.y, minimumZ) );
     }    
 }
 
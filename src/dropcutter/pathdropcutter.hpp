@@ -69,6 +69,8 @@ class PathDropCutter : public Operation {
         double minimumZ;
         /// list of CL-points
         std::vector<CLPoint> clpoints;
+        /// the sampled path, dropped in place by BatchDropCutter::runRecords()
+        std::vector<CLRecord> samples;
     private:
         /// the algorithm
         void uniform_sampling_run();
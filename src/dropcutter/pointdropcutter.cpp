@@ -22,10 +22,6 @@
 #include <boost/foreach.hpp>
 #include <boost/progress.hpp>
 
-#ifdef _OPENMP 
-    #include <omp.h>
-#endif
-
 #include "point.hpp"
 #include "triangle.hpp"
 #include "pointdropcutter.hpp"
@@ -38,20 +34,17 @@ namespace ocl
 
 PointDropCutter::PointDropCutter() {
     nCalls = 0;
-#ifdef _OPENMP
-    nthreads = omp_get_num_procs(); // figure out how many cores we have
-#endif
     cutter = NULL;
     bucketSize = 1;
-    root = new KDTree<Triangle>();
 }
 
 void PointDropCutter::setSTL(const STLSurf &s) {
     //std::cout << "PointDropCutter::setSTL()\n";
     surf = &s;
-    root->setXYDimensions(); // we search for triangles in the XY plane, don't care about Z-coordinate
-    root->setBucketSize( bucketSize );
-    root->build(s.tris);
+    SpatialIndex<Triangle>* index = newIndex();
+    index->setXYDimensions(); // we search for triangles in the XY plane, don't care about Z-coordinate
+    index->setBucketSize( bucketSize );
+    root = s.indexCache.get( indexType, index, s.tris );
 }
 
 void PointDropCutter::run(CLPoint& clp) {
@@ -64,19 +57,16 @@ void PointDropCutter::run(CLPoint& clp) {
 void PointDropCutter::pointDropCutter1(CLPoint& clp) {
     nCalls = 0;
     int calls=0;
-    std::list<Triangle>* tris;
-    //tris=new std::list<Triangle>();
-    tris = root->search_cutter_overlap( cutter, &clp );
-    std::list<Triangle>::iterator it;
-    for( it=tris->begin(); it!=tris->end() ; ++it) { // loop over found triangles  
-        if ( cutter->overlaps(clp,*it) ) { // cutter overlap triangle? check
-            if (clp.below(*it)) {
-                cutter->dropCutter(clp,*it);
+    root->search_cutter_overlap( cutter, &clp, tris );
+    std::vector<const Triangle*>::const_iterator it;
+    for( it=tris.begin(); it!=tris.end() ; ++it) { // loop over found triangles  
+        if ( cutter->overlaps(clp,**it) ) { // cutter overlap triangle? check
+            if (clp.below(**it)) {
+                cutter->dropCutter(clp,**it);
                 ++calls;
             }
         }
     }
-    delete( tris );
     nCalls = calls;
     return;
 }
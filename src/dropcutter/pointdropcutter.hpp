@@ -42,7 +42,6 @@ class PointDropCutter : public Operation {
         PointDropCutter();
         virtual ~PointDropCutter() {
             //std::cout << " ~PointDropCutter() \n";
-            delete root;
         }
         void setSTL(const STLSurf &s);
         void run(CLPoint& cl);
@@ -54,6 +53,8 @@ class PointDropCutter : public Operation {
     protected:
         /// first simple implementation of this operation
         void pointDropCutter1(CLPoint& clp);
+        /// triangles found by the kd-tree search, re-used between calls to run(CLPoint&)
+        std::vector<const Triangle*> tris;
 };
 
 } // end namespace
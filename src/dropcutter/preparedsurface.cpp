@@ -0,0 +1,74 @@
+/*  $Id$
+ * 
+ *  Copyright (c) 2010-2011 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *  
+ *  This file is part of OpenCAMlib 
+ *  (see https://github.com/aewallin/opencamlib).
+ *  
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <boost/foreach.hpp>
+
+#include "preparedsurface.hpp"
+#include "stlsurf.hpp"
+#include "millingcutter.hpp"
+
+namespace ocl
+{
+
+PreparedSurface::PreparedSurface(const STLSurf& s, const MillingCutter& c, IndexType t, 
+                                 unsigned int b, std::shared_ptr<Executor> e) 
+    : surf(s), cutter(c), indexType(t), bucketSize(b), 
+      executor( e ? e : ThreadPool::shared( ThreadPool::hardwareThreads() ) ) {
+    DropCutterJob warmup(*this); // builds the XY index and the TriangleStore in the surface caches
+}
+
+// The Operations look up the shared index in STLSurf::indexCache, once per job.
+// After that a job touches only its own data and the immutable index.
+DropCutterJob::DropCutterJob(const PreparedSurface& ps) {
+    op.setIndexType( ps.getIndexType() );
+    op.setBucketSize( ps.getBucketSize() );
+    op.setExecutor( ps.getExecutor() );
+    op.setCutter( &ps.getCutter() );
+    op.setSTL( ps.getSTL() );
+}
+
+std::vector<CLPoint> DropCutterJob::getCLPoints() const {
+    std::vector<CLPoint> clv;
+    clv.reserve( points.size() );
+    BOOST_FOREACH( const CLRecord& r, points ) {
+        clv.push_back( r.toCLPoint() );
+    }
+    return clv;
+}
+
+void DropCutterJob::run() {
+    op.runRecords( points );
+}
+
+PushCutterJob::PushCutterJob(const PreparedSurface& ps, bool x) {
+    if (x)
+        op.setXDirection();
+    else
+        op.setYDirection();
+    op.setIndexType( ps.getIndexType() );
+    op.setBucketSize( ps.getBucketSize() );
+    op.setExecutor( ps.getExecutor() );
+    op.setCutter( &ps.getCutter() );
+    op.setSTL( ps.getSTL() );
+}
+
+} // end namespace
+// end file preparedsurface.cpp
@@ -0,0 +1,128 @@
+/*  $Id$
+ * 
+ *  Copyright (c) 2010 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *  
+ *  This file is part of OpenCAMlib 
+ *  (see https://github.com/aewallin/opencamlib).
+ *  
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PREPAREDSURFACE_H
+#define PREPAREDSURFACE_H
+
+#include <memory>
+#include <vector>
+
+#include "operation.hpp"
+#include "executor.hpp"
+#include "clrecord.hpp"
+#include "fiber.hpp"
+#include "batchdropcutter.hpp"
+#include "batchpushcutter.hpp"
+
+namespace ocl
+{
+
+class STLSurf;
+class MillingCutter;
+
+///
+/// \brief an STLSurf and a MillingCutter, set up once and shared by many jobs
+///
+/// A PreparedSurface is not changed after construction. Any number of DropCutterJob and
+/// PushCutterJob objects can use it from different threads at the same time. Each job
+/// keeps its own inputs, outputs and call counts, so jobs need no locking between them.
+/// The surface and the cutter must outlive the PreparedSurface, and must not be changed while it is used.
+class PreparedSurface {
+    public:
+        /// prepare surface s for cutter c. Builds the drop-cutter index of type t and the
+        /// TriangleStore. Push-cutter indexes are built by the first PushCutterJob that needs them.
+        /// The jobs run on e, or on ThreadPool::shared() with all hardware threads if e is null.
+        PreparedSurface(const STLSurf& s, const MillingCutter& c, IndexType t = KDTREE, 
+                        unsigned int bucketSize = 1, std::shared_ptr<Executor> e = std::shared_ptr<Executor>() );
+        /// return the surface
+        const STLSurf& getSTL() const {return surf;}
+        /// return the cutter
+        const MillingCutter& getCutter() const {return cutter;}
+        /// return the type of the spatial indexes
+        IndexType getIndexType() const {return indexType;}
+        /// return the bucket-size of the spatial indexes
+        unsigned int getBucketSize() const {return bucketSize;}
+        /// return the Executor the jobs run on
+        std::shared_ptr<Executor> getExecutor() const {return executor;}
+    private:
+        /// the surface
+        const STLSurf& surf;
+        /// the cutter
+        const MillingCutter& cutter;
+        /// type of the spatial indexes
+        const IndexType indexType;
+        /// bucket-size of the spatial indexes
+        const unsigned int bucketSize;
+        /// runs the jobs
+        const std::shared_ptr<Executor> executor;
+};
+
+///
+/// \brief one drop-cutter run against a PreparedSurface
+///
+/// A DropCutterJob holds its own points and results. Jobs on the same PreparedSurface
+/// can run at the same time from different threads.
+class DropCutterJob {
+    public:
+        /// a job without points on the prepared surface ps
+        explicit DropCutterJob(const PreparedSurface& ps);
+        /// add an input point
+        void appendPoint(const CLPoint& p) {points.push_back( CLRecord(p.x, p.y, p.z) );}
+        /// return the points, the input before run() and the result after it
+        std::vector<CLRecord>& getPoints() {return points;}
+        /// return the result as CLPoints
+        std::vector<CLPoint> getCLPoints() const;
+        /// drop the cutter at all points
+        void run();
+        /// return the number of MillingCutter::dropCutter() calls made by run()
+        int getCalls() const {return op.getCalls();}
+    private:
+        /// the points, dropped in place
+        std::vector<CLRecord> points;
+        /// does the work, on the index shared through the surface
+        BatchDropCutter op;
+};
+
+///
+/// \brief one push-cutter run along x- or y-fibers against a PreparedSurface
+///
+/// A PushCutterJob holds its own fibers. Jobs on the same PreparedSurface
+/// can run at the same time from different threads.
+class PushCutterJob {
+    public:
+        /// a job without fibers on the prepared surface ps, for x-fibers if x is true, else for y-fibers
+        PushCutterJob(const PreparedSurface& ps, bool x);
+        /// add an input fiber
+        void appendFiber(Fiber& f) {op.appendFiber(f);}
+        /// return the fibers, with their intervals after run()
+        std::vector<Fiber>& getFibers() {return *op.getFibers();}
+        /// push the cutter along all fibers
+        void run() {op.run();}
+        /// return the number of MillingCutter::pushCutter() calls made by run()
+        int getCalls() const {return op.getCalls();}
+    private:
+        /// does the work, on the index shared through the surface
+        BatchPushCutter op;
+};
+
+} // end namespace
+#endif
+// end file preparedsurface.hpp
@@ -102,7 +102,8 @@ EMSCRIPTEN_BINDINGS(opencamlib)
         .value("ERROR", ERROR);
 
     class_<STLReader>("STLReader")
-        .constructor<const std::wstring &, STLSurf &>();
+        .constructor<const std::wstring &, STLSurf &>()
+        .constructor<const std::wstring &, STLSurf &, double>();
 
     class_<STLSurf>("STLSurf")
         .constructor()
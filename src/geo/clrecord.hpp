@@ -0,0 +1,79 @@
+/*  $Id$
+ *
+ *  Copyright (c) 2010 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *
+ *  This file is part of OpenCAMlib
+ *  (see https://github.com/aewallin/opencamlib).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef CLRECORD_H
+#define CLRECORD_H
+
+#include <type_traits>
+
+#include "clpoint.hpp"
+
+namespace ocl
+{
+
+///
+/// \brief a drop-cutter result without the CLPoint overhead
+///
+/// CLRecord holds the same data as a CLPoint and its CCPoint: the cl-point, the cc-point and its type.
+/// It has no vtable and no heap-allocated CCPoint, so vectors of CLRecords are half the size of
+/// vectors of CLPoints, and copy with memcpy. Batch operations fill them directly,
+/// see BatchDropCutter::runRecords(). Convert to CLPoint only where the API needs one.
+struct CLRecord {
+    /// uninitialized, like a plain struct
+    CLRecord() = default;
+    /// a record at (x,y,z) with no cc-point
+    CLRecord(double x_, double y_, double z_) : x(x_), y(y_), z(z_), ccx(0), ccy(0), ccz(0), type(NONE) {}
+    /// a record of cl and its CCPoint
+    explicit CLRecord(const CLPoint& cl) { set(cl); }
+    /// copy cl and its CCPoint to this record
+    void set(const CLPoint& cl) {
+        const CCPoint& cc = *cl.cc.load();
+        x = cl.x; y = cl.y; z = cl.z;
+        ccx = cc.x; ccy = cc.y; ccz = cc.z;
+        type = cc.type;
+    }
+    /// return the cc-point
+    CCPoint getCC() const { return CCPoint(ccx, ccy, ccz, type); }
+    /// return this record as a CLPoint
+    CLPoint toCLPoint() const { 
+        CCPoint cc = getCC();
+        return CLPoint(x, y, z, cc); 
+    }
+    /// cl-point x-coordinate
+    double x;
+    /// cl-point y-coordinate
+    double y;
+    /// cl-point z-coordinate
+    double z;
+    /// cc-point x-coordinate
+    double ccx;
+    /// cc-point y-coordinate
+    double ccy;
+    /// cc-point z-coordinate
+    double ccz;
+    /// type of the cc-point, NONE if the cutter touched no triangle
+    CCType type;
+};
+
+static_assert( std::is_trivially_copyable<CLRecord>::value, "CLRecord must be trivially copyable" );
+
+} // end namespace
+#endif
+// end file clrecord.hpp
@@ -0,0 +1,172 @@
+/*  $Id$
+ *
+ *  Copyright (c) 2010-2011 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *
+ *  This file is part of OpenCAMlib
+ *  (see https://github.com/aewallin/opencamlib).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+
+#include <boost/foreach.hpp>
+
+#include "indexedmesh.hpp"
+
+namespace ocl
+{
+
+std::size_t WeldKeyHash::operator()(const WeldKey& k) const {
+    std::size_t h = 0;
+    for (int n=0; n<3; ++n)
+        h ^= std::hash<unsigned long long>()( k.c[n] ) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    return h;
+}
+
+IndexedMesh::IndexedMesh() : tolerance(0.0) {}
+
+IndexedMesh::IndexedMesh(double tol) : tolerance(tol) {
+    assert( tolerance >= 0.0 );
+}
+
+IndexedMesh::IndexedMesh(const std::list<Triangle>& tris) : tolerance(0.0) {
+    vertices.reserve( tris.size()/2 );
+    triangles.reserve( 3*tris.size() );
+    triangleEdges.reserve( 3*tris.size() );
+    edges.reserve( 3*tris.size()/2 );
+    BOOST_FOREACH(const Triangle& t, tris)
+        addTriangle( addVertex( t.p[0] ), addVertex( t.p[1] ), addVertex( t.p[2] ) );
+    finish();
+}
+
+WeldKey IndexedMesh::key(const Point& p, int di, int dj, int dk) const {
+    WeldKey k;
+    if ( tolerance == 0.0 ) { // the coordinates, with -0.0 as 0.0
+        const double c[3] = { p.x + 0.0, p.y + 0.0, p.z + 0.0 };
+        std::memcpy( k.c, c, sizeof(k.c) );
+    } else { // the grid cell, with cells of side tolerance
+        k.c[0] = (unsigned long long)( (long long)std::floor( p.x/tolerance ) + di );
+        k.c[1] = (unsigned long long)( (long long)std::floor( p.y/tolerance ) + dj );
+        k.c[2] = (unsigned long long)( (long long)std::floor( p.z/tolerance ) + dk );
+    }
+    return k;
+}
+
+unsigned int IndexedMesh::addVertex(const Point& p) {
+    typedef std::unordered_multimap<WeldKey, unsigned int, WeldKeyHash>::const_iterator Iter;
+    const WeldKey own = key(p,0,0,0);
+    if ( tolerance == 0.0 ) {
+        Iter it = vertexMap.find( own );
+        if ( it != vertexMap.end() )
+            return it->second;
+    } else {
+        // a vertex within tolerance is in the same or a neighbouring cell
+        bool found = false;
+        unsigned int best = 0;
+        double bestd = 0.0;
+        for (int di=-1; di<=1; ++di) {
+            for (int dj=-1; dj<=1; ++dj) {
+                for (int dk=-1; dk<=1; ++dk) {
+                    std::pair<Iter, Iter> range = vertexMap.equal_range( key(p,di,dj,dk) );
+                    for (Iter it=range.first; it!=range.second; ++it) {
+                        const double d = ( vertices[it->second] - p ).norm();
+                        if ( d <= tolerance && ( !found || d < bestd || ( d == bestd && it->second < best ) ) ) {
+                            found = true;
+                            best = it->second;
+                            bestd = d;
+                        }
+                    }
+                }
+            }
+        }
+        if (found)
+            return best;
+    }
+    vertices.push_back( p );
+    vertexMap.insert( std::make_pair( own, (unsigned int)vertices.size()-1 ) );
+    return vertices.size()-1;
+}
+
+unsigned int IndexedMesh::addTriangle(unsigned int a, unsigned int b, unsigned int c) {
+    const unsigned int t = size();
+    const unsigned int v[3] = { a, b, c };
+    for (int k=0; k<3; k++)
+        triangles.push_back( v[k] );
+    for (int k=0; k<3; k++) {
+        const unsigned int v1 = v[k];
+        const unsigned int v2 = v[(k+1)%3];
+        const unsigned long long edgekey = ( (unsigned long long)std::min(v1,v2) << 32 ) | std::max(v1,v2);
+        std::pair< std::unordered_map<unsigned long long, unsigned int>::iterator, bool > 
+                ins = edgeMap.insert( std::make_pair( edgekey, (unsigned int)edges.size() ) );
+        if ( ins.second ) {
+            MeshEdge e;
+            e.v[0] = v1;
+            e.v[1] = v2;
+            e.tri[0] = t;
+            e.tri[1] = NO_TRIANGLE;
+            e.count = 1;
+            edges.push_back( e );
+        } else {
+            MeshEdge& e = edges[ ins.first->second ];
+            if ( e.tri[1] == NO_TRIANGLE )
+                e.tri[1] = t;
+            ++e.count;
+        }
+        triangleEdges.push_back( ins.first->second );
+    }
+    return t;
+}
+
+Triangle IndexedMesh::triangle(unsigned int i) const {
+    return Triangle( vertices[ triangles[3*i] ], vertices[ triangles[3*i+1] ], vertices[ triangles[3*i+2] ] );
+}
+
+unsigned int IndexedMesh::boundaryEdges() const {
+    unsigned int n = 0;
+    BOOST_FOREACH(const MeshEdge& e, edges)
+        n += ( e.count == 1 );
+    return n;
+}
+
+unsigned int IndexedMesh::nonManifoldEdges() const {
+    unsigned int n = 0;
+    BOOST_FOREACH(const MeshEdge& e, edges)
+        n += ( e.count > 2 );
+    return n;
+}
+
+void IndexedMesh::finish() {
+    std::unordered_multimap<WeldKey, unsigned int, WeldKeyHash>().swap( vertexMap );
+    std::unordered_map<unsigned long long, unsigned int>().swap( edgeMap );
+}
+
+unsigned int IndexedMesh::bytes() const {
+    return vertices.size()*sizeof(Point) + ( triangles.size() + triangleEdges.size() )*sizeof(unsigned int) 
+           + edges.size()*sizeof(MeshEdge);
+}
+
+std::string IndexedMesh::str() const {
+    std::ostringstream o;
+    o << "IndexedMesh(N=" << size() << ", vertices=" << vertices.size() << ", edges=" << edges.size() 
+      << ", boundary=" << boundaryEdges() << ", non-manifold=" << nonManifoldEdges() << ")";
+    return o.str();
+}
+
+} // end namespace
+// end file indexedmesh.cpp
@@ -0,0 +1,122 @@
+/*  $Id$
+ *
+ *  Copyright (c) 2010-2011 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *
+ *  This file is part of OpenCAMlib
+ *  (see https://github.com/aewallin/opencamlib).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef INDEXEDMESH_H
+#define INDEXEDMESH_H
+
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "triangle.hpp"
+
+namespace ocl
+{
+
+/// an edge of an IndexedMesh, and the triangles on either side of it
+struct MeshEdge {
+    /// the end-points, indices into IndexedMesh::vertices. The direction is that of tri[0].
+    unsigned int v[2];
+    /// the first two triangles with this edge. tri[1] is IndexedMesh::NO_TRIANGLE on a boundary edge.
+    unsigned int tri[2];
+    /// the number of triangles with this edge. More than two on a non-manifold edge.
+    unsigned int count;
+};
+
+/// a vertex position rounded to the welding grid of an IndexedMesh, or the exact coordinates
+/// when there is no tolerance
+struct WeldKey {
+    /// the grid cell or the coordinates, as 64-bit patterns
+    unsigned long long c[3];
+    /// true if the keys are equal
+    bool operator==(const WeldKey& o) const {
+        return c[0] == o.c[0] && c[1] == o.c[1] && c[2] == o.c[2];
+    }
+};
+
+/// hash of a WeldKey
+struct WeldKeyHash {
+    /// the hash of k
+    std::size_t operator()(const WeldKey& k) const;
+};
+
+///
+/// \brief a triangle mesh as shared vertices, triangle index triples, and an edge table
+///
+/// Vertices closer than the tolerance are welded into one, so that triangles sharing
+/// a corner share a vertex index, and triangles sharing a side share a MeshEdge.
+/// STLReader builds the mesh while reading, and STLSurf::getMesh() returns it.
+/// TriangleStore uses it to test each vertex and edge of the surface once.
+class IndexedMesh {
+    public:
+        /// an empty mesh that welds only vertices with exactly the same coordinates
+        IndexedMesh();
+        /// an empty mesh that welds vertices within distance tolerance of each other.
+        /// A new vertex is welded to the nearest vertex already in the mesh, if there is one within tolerance.
+        explicit IndexedMesh(double tolerance);
+        /// the mesh of tris, with exact welding. Triangle i of the mesh is the i:th of tris.
+        explicit IndexedMesh(const std::list<Triangle>& tris);
+        /// return the index of p, welded to an existing vertex or added as a new one
+        unsigned int addVertex(const Point& p);
+        /// add the triangle of vertices a, b and c, and its edges. Returns the index of the triangle.
+        unsigned int addTriangle(unsigned int a, unsigned int b, unsigned int c);
+        /// return number of triangles
+        unsigned int size() const { return triangles.size()/3; }
+        /// return triangle i with the vertex positions of the mesh
+        Triangle triangle(unsigned int i) const;
+        /// return the welding tolerance
+        double getTolerance() const { return tolerance; }
+        /// return the number of edges with only one triangle
+        unsigned int boundaryEdges() const;
+        /// return the number of edges with more than two triangles
+        unsigned int nonManifoldEdges() const;
+        /// free the hash tables used by addVertex() and addTriangle(). The mesh can not be added to after this.
+        void finish();
+        /// return an estimate of the memory used by the arrays, in bytes
+        unsigned int bytes() const;
+        /// string repr
+        std::string str() const;
+        /// value of MeshEdge::tri for a missing triangle
+        static const unsigned int NO_TRIANGLE = 0xFFFFFFFFu;
+
+    // DATA
+        /// the welded vertices
+        std::vector<Point> vertices;
+        /// the vertex indices of triangle i are triangles[3*i], triangles[3*i+1] and triangles[3*i+2]
+        std::vector<unsigned int> triangles;
+        /// the unique edges
+        std::vector<MeshEdge> edges;
+        /// edge k of triangle i, from vertex k to vertex (k+1)%3, is edges[ triangleEdges[3*i+k] ]
+        std::vector<unsigned int> triangleEdges;
+    private:
+        /// the welding key of p. With a tolerance, the key of the grid cell offset by (di, dj, dk) from that of p.
+        WeldKey key(const Point& p, int di, int dj, int dk) const;
+        /// vertices within distance tolerance are welded, zero for exact welding
+        double tolerance;
+        /// the vertices by WeldKey, see addVertex()
+        std::unordered_multimap<WeldKey, unsigned int, WeldKeyHash> vertexMap;
+        /// the edges by ( lower, higher ) vertex index
+        std::unordered_map<unsigned long long, unsigned int> edgeMap;
+};
+
+} // end namespace
+#endif
+// end file indexedmesh.hpp
@@ -21,18 +21,53 @@
  *  You should have received a copy of the GNU Lesser General Public License
  *  along with this program. If not, see <http://www.gnu.org/licenses/>.
 */
+#include <algorithm>
 #include <fstream>  // required by read_from_file()
+#include <iostream>
+#include <iterator>
 #include <sstream>
 #include <cstring>
 #include <list>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <boost/foreach.hpp>
+
+// the binary files are memory-mapped where the platform has mmap(), and read into a buffer elsewhere
+#if defined(__unix__) || defined(__APPLE__)
+    #define OCL_MMAP
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
 
 #include "stlreader.hpp"
 #include "stlsurf.hpp"
+#include "indexedmesh.hpp"
+#include "executor.hpp"
 
 namespace ocl
 {
 
-    STLReader::STLReader(const std::wstring &filepath, STLSurf& surface) {
+    STLReader::STLReader(const std::wstring &filepath, STLSurf& surface) 
+        : tolerance(0.0), nthreads( ThreadPool::hardwareThreads() ) {
+        read_from_file(filepath.c_str(), surface);
+    }
+
+    STLReader::STLReader(const std::wstring &filepath, STLSurf& surface, double tol) 
+        : tolerance(tol), nthreads( ThreadPool::hardwareThreads() ) {
+        read_from_file(filepath.c_str(), surface);
+    }
+
+    STLReader::STLReader(const std::wstring &filepath, STLSurf& surface, double tol, unsigned int threads) 
+        : tolerance(tol), nthreads(threads) {
+        read_from_file(filepath.c_str(), surface);
+    }
+
+    STLReader::STLReader(const std::wstring &filepath, STLSurf& surface, double tol, std::shared_ptr<Executor> ex) 
+        : tolerance(tol), nthreads( ex->concurrency() ), executor(ex) {
         read_from_file(filepath.c_str(), surface);
     }
 
@@ -54,43 +89,120 @@ namespace ocl
         return str_for_Ttc.c_str();
     }
 
-    void STLReader::read_from_file(const wchar_t* filepath, STLSurf& surface) {
-        // read the stl file
-        std::ifstream ifs(Ttc(filepath), ios::binary);
-        if(!ifs)return;
+    /// the bytes of a file, memory-mapped where the platform has mmap(), else read into a buffer
+    class FileBytes {
+        public:
+            /// map the file at path. data() is NULL if it can not be opened.
+            explicit FileBytes(const char* path) : ptr(NULL), length(0) {
+#ifdef OCL_MMAP
+                int fd = open(path, O_RDONLY);
+                if (fd < 0)
+                    return;
+                struct stat st;
+                if ( fstat(fd, &st) == 0 && st.st_size > 0 ) {
+                    void* m = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if ( m != MAP_FAILED ) {
+                        ptr = static_cast<const char*>(m);
+                        length = st.st_size;
+                    }
+                }
+                close(fd); // the mapping stays valid
+#else
+                std::ifstream ifs(path, ios::binary);
+                if (!ifs)
+                    return;
+                buffer.assign( std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>() );
+                if ( !buffer.empty() ) {
+                    ptr = &buffer[0];
+                    length = buffer.size();
+                }
+#endif
+            }
+            /// unmap the file
+            ~FileBytes() {
+#ifdef OCL_MMAP
+                if (ptr)
+                    munmap( const_cast<char*>(ptr), length );
+#endif
+            }
+            /// the first byte of the file, or NULL
+            const char* data() const {return ptr;}
+            /// the size of the file in bytes
+            std::size_t size() const {return length;}
+        private:
+            FileBytes(const FileBytes&);
+            FileBytes& operator=(const FileBytes&);
+            /// the first byte
+            const char* ptr;
+            /// the number of bytes
+            std::size_t length;
+#ifndef OCL_MMAP
+            /// the file contents
+            std::vector<char> buffer;
+#endif
+    };
 
-        char solid_string[6] = "aaaaa";
-        ifs.read(solid_string, 5);
-        if(ifs.eof())return;
-        if(strcmp(solid_string, "solid"))
-        {
-            // try binary file read
+    /// size of the binary STL header, including the facet count
+    static const std::size_t HEADER_BYTES = 84;
+    /// size of one binary STL facet: normal, three vertices, and the attribute
+    static const std::size_t FACET_BYTES = 50;
 
-            // read the header
-            char header[81];
-            header[80] = 0;
-            memcpy(header, solid_string, 5);
-            ifs.read(&header[5], 75);
+    /// the facet count of the binary STL header
+    static unsigned int facetCount(const FileBytes& file) {
+        unsigned int n;
+        memcpy(&n, file.data() + 80, 4);
+        return n;
+    }
 
-            unsigned int num_facets = 0;
-            ifs.read((char*)(&num_facets), 4);
+    // binary files that do not start with "solid" are binary. Some exporters also start the header
+    // of binary files with "solid", those are recognized by their size, which matches the facet count.
+    static bool isBinary(const FileBytes& file) {
+        if ( strncmp(file.data(), "solid", 5) )
+            return true;
+        return file.size() >= HEADER_BYTES && file.size() == HEADER_BYTES + FACET_BYTES*(std::size_t)facetCount(file);
+    }
 
-            for(unsigned int i = 0; i<num_facets; i++)
-            {
-                float n[3];
-                float x[3][3];
-                ifs.read((char*)(n), 12);
-                ifs.read((char*)(x[0]), 36);
-                short attr;
-                ifs.read((char*)(&attr), 2);
-                surface.addTriangle(Triangle(Point(x[0][0], x[0][1], x[0][2]), 
-                    Point(x[1][0], x[1][1], x[1][2]), 
-                    Point(x[2][0], x[2][1], x[2][2])));
-            }
+    /// number of facets per parallel_for() index of STLReader::read_binary()
+    static const unsigned int FACET_BLOCK = 4096;
+
+    /// true if the facet x, the normal and three vertices of a binary STL facet, has
+    /// a zero-length edge. STLSurf::addTriangle() asserts that there is none.
+    static bool isDegenerate(const float x[12]) {
+        const float* p[3] = { x+3, x+6, x+9 };
+        for (int k=0; k<3; k++) {
+            const float* a = p[k];
+            const float* b = p[(k+1)%3];
+            if ( a[0] == b[0] && a[1] == b[1] && a[2] == b[2] )
+                return true;
+        }
+        return false;
+    }
+
+    Executor& STLReader::getExecutor() {
+        if ( !executor )
+            executor = ThreadPool::shared(nthreads);
+        return *executor;
+    }
+
+    void STLReader::read_from_file(const wchar_t* filepath, STLSurf& surface) {
+        // read the stl file
+        const char* path = Ttc(filepath);
+        FileBytes file(path);
+        if ( !file.data() || file.size() < 5 )
+            return;
+        // the mesh describes the surface only if it has no earlier triangles
+        const bool empty = ( surface.size() == 0 );
+        IndexedMesh mesh(tolerance);
+        if ( isBinary(file) )
+        {
+            read_binary(file, mesh, surface);
         }
         else
         {
             // "solid" already found
+            std::ifstream ifs(path, ios::binary);
+            char solid_string[6] = "aaaaa";
+            ifs.read(solid_string, 5);
             char str[1024] = "solid";
             ifs.getline(&str[5], 1024);
             //char title[1024];
@@ -147,14 +259,102 @@ namespace ocl
                     {
                         if(vertex == 2)
                         {
-                            surface.addTriangle(Triangle(Point(x[0][0], x[0][1], x[0][2]), 
-                                Point(x[1][0], x[1][1], x[1][2]), 
-                                Point(x[2][0], x[2][1], x[2][2])));
+                            addFacet(x, mesh, surface);
                         }
                     }
                 }
             }
         }
+        if ( empty && mesh.size() == surface.size() ) { // the binary reader leaves it empty without a tolerance
+            mesh.finish();
+            surface.setMesh( std::make_shared<const IndexedMesh>( std::move(mesh) ) );
+        }
+    }
+
+    // the facets are parsed in parallel into a list of triangles, which is then moved into the surface.
+    // Without a tolerance the mesh is left empty, and STLSurf::getMesh() builds it when it is needed.
+    void STLReader::read_binary(const FileBytes& file, IndexedMesh& mesh, STLSurf& surface) {
+        if ( file.size() < HEADER_BYTES ) {
+            std::cout << "STLReader: binary file of " << file.size() << " bytes is too short for the header.\n";
+            return;
+        }
+        const unsigned int declared = facetCount(file);
+        const std::size_t room = ( file.size() - HEADER_BYTES ) / FACET_BYTES;
+        unsigned int N = declared;
+        if ( declared > room ) {
+            std::cout << "STLReader: the header gives " << declared << " facets, the file has room for " 
+                      << room << ". Reading " << room << ".\n";
+            N = room;
+        } else if ( file.size() != HEADER_BYTES + FACET_BYTES*(std::size_t)declared ) {
+            std::cout << "STLReader: " << file.size() - HEADER_BYTES - FACET_BYTES*(std::size_t)declared 
+                      << " bytes after the " << declared << " facets are ignored.\n";
+        }
+        // each block of facets is parsed into its own list, and the lists are joined in file order
+        Executor& ex = getExecutor();
+        const unsigned int nblocks = ( N + FACET_BLOCK - 1 ) / FACET_BLOCK;
+        std::vector< std::list<Triangle> > blocks( nblocks );
+        std::vector<Bbox> boxes( ex.concurrency() );
+        std::vector<unsigned int> counts( ex.concurrency(), 0 ); // a Bbox with no points is not empty, but at the origin
+        std::vector<unsigned int> degenerate( ex.concurrency(), 0 );
+        const char* facets = file.data() + HEADER_BYTES;
+        parallel_for( ex, nblocks, 1, [&](unsigned int begin, unsigned int end, unsigned int slot) {
+            for (unsigned int b=begin; b<end; ++b) {
+                const unsigned int last = std::min( N, (b+1)*FACET_BLOCK );
+                for (unsigned int i=b*FACET_BLOCK; i<last; ++i) {
+                    float x[12]; // the normal, which is not used, and the vertices
+                    memcpy(x, facets + FACET_BYTES*(std::size_t)i, sizeof(x));
+                    if ( isDegenerate(x) ) {
+                        degenerate[slot]++;
+                        continue;
+                    }
+                    blocks[b].emplace_back( Point(x[3], x[4], x[5]), Point(x[6], x[7], x[8]), Point(x[9], x[10], x[11]) );
+                    boxes[slot].addTriangle( blocks[b].back() );
+                    counts[slot]++;
+                }
+            }
+        } );
+        unsigned int dropped = 0;
+        BOOST_FOREACH(unsigned int d, degenerate) {
+            dropped += d;
+        }
+        if ( dropped > 0 )
+            std::cout << "STLReader: " << dropped << " facets with a zero-length edge are left out.\n";
+        std::list<Triangle> tris;
+        for (unsigned int b=0; b<nblocks; ++b)
+            tris.splice( tris.end(), blocks[b] );
+        Bbox bb;
+        if ( tolerance > 0.0 ) { // welding is sequential, and moves the vertices
+            std::list<Triangle>::iterator it = tris.begin();
+            while ( it != tris.end() ) {
+                unsigned int v[3];
+                for (int k=0; k<3; k++)
+                    v[k] = mesh.addVertex( it->p[k] );
+                if ( v[0] == v[1] || v[1] == v[2] || v[2] == v[0] ) {
+                    it = tris.erase(it); // collapsed by the welding
+                } else {
+                    *it = mesh.triangle( mesh.addTriangle(v[0], v[1], v[2]) );
+                    bb.addTriangle( *it );
+                    ++it;
+                }
+            }
+        } else {
+            for (unsigned int n=0; n<boxes.size(); ++n) {
+                if ( counts[n] > 0 ) {
+                    bb.addPoint( boxes[n].minpt );
+                    bb.addPoint( boxes[n].maxpt );
+                }
+            }
+        }
+        surface.addTriangles(tris, bb);
+    }
+
+    void STLReader::addFacet(const float x[3][3], IndexedMesh& mesh, STLSurf& surface) {
+        unsigned int v[3];
+        for (int k=0; k<3; k++)
+            v[k] = mesh.addVertex( Point(x[k][0], x[k][1], x[k][2]) );
+        if ( v[0] == v[1] || v[1] == v[2] || v[2] == v[0] )
+            return; // a zero-length edge, or collapsed by the welding
+        surface.addTriangle( mesh.triangle( mesh.addTriangle(v[0], v[1], v[2]) ) );
     }
 
 }
@@ -22,26 +22,59 @@
 #ifndef STLREADER_H
 #define STLREADER_H
 
+#include <memory>
+#include <string>
+
 namespace ocl
 {
     
 class STLSurf;
+class IndexedMesh;
+class FileBytes;
+class Executor;
 
 
 /// \brief STL file reader, reads an STL file and calls addTriangle on the STLSurf
 ///
-
+/// Binary files are memory-mapped and parsed in parallel. The vertices of the facets are welded
+/// into an IndexedMesh while reading, and when the surface was empty the mesh is set with STLSurf::setMesh().
+/// Binary files read without a tolerance are not welded here, see STLSurf::getMesh().
+/// Facets with a zero-length edge are left out.
 class STLReader {
     public:
-        STLReader(){};
-        /// construct with file name and surface to fill
+        STLReader() : tolerance(0.0), nthreads(0) {};
+        /// construct with file name and surface to fill. Only vertices with exactly
+        /// the same coordinates are welded.
         STLReader(const std::wstring &filepath, STLSurf& surface);
+        /// construct with file name and surface to fill. Vertices within distance tolerance
+        /// are welded, see IndexedMesh. The triangles get the welded vertex positions, and
+        /// the facets that welding collapses to a line or a point are left out.
+        STLReader(const std::wstring &filepath, STLSurf& surface, double tolerance);
+        /// as above, and binary files are parsed on the process-wide ThreadPool::shared(threads),
+        /// as with Operation::setThreads(). The other constructors use the hardware threads.
+        STLReader(const std::wstring &filepath, STLSurf& surface, double tolerance, unsigned int threads);
+        /// as above, and binary files are parsed on ex, e.g. a thread pool shared with the host
+        /// application, as with Operation::setExecutor().
+        STLReader(const std::wstring &filepath, STLSurf& surface, double tolerance, std::shared_ptr<Executor> ex);
         /// destructor
         virtual ~STLReader();
 
     private:
         /// read STL-surface from file
         void read_from_file(const wchar_t* filepath, STLSurf& surface);
+        /// read the facets of a binary STL file in parallel. The facet count of the header
+        /// is checked against the file size, and only the facets in the file are read.
+        void read_binary(const FileBytes& file, IndexedMesh& mesh, STLSurf& surface);
+        /// weld the vertices x of a facet into mesh, and add it to surface
+        void addFacet(const float x[3][3], IndexedMesh& mesh, STLSurf& surface);
+        /// return the Executor given to the constructor, or the shared pool of nthreads threads
+        Executor& getExecutor();
+        /// the welding tolerance
+        double tolerance;
+        /// number of threads of the shared pool, when no Executor is given
+        unsigned int nthreads;
+        /// the Executor binary files are parsed on
+        std::shared_ptr<Executor> executor;
 };
 
 }
@@ -20,6 +20,7 @@
 */
 
 #include <list>
+#include <memory>
 #include <cassert>
 
 #include <boost/foreach.hpp>
@@ -29,6 +30,45 @@
 namespace ocl
 {
 
+STLSurf& STLSurf::operator=(const STLSurf& s) {
+    if (this != &s) {
+        tris = s.tris;
+        bb = s.bb;
+        clearCache();
+    }
+    return *this;
+}
+
+std::shared_ptr<const TriangleStore> STLSurf::getStore() const {
+    std::shared_ptr<const TriangleStore> s = std::atomic_load( &store );
+    if (!s) { // two threads may both build the store, the last one is kept
+        s = std::make_shared<const TriangleStore>( tris, getMesh() );
+        std::atomic_store( &store, s );
+    }
+    return s;
+}
+
+std::shared_ptr<const IndexedMesh> STLSurf::getMesh() const {
+    std::shared_ptr<const IndexedMesh> m = std::atomic_load( &mesh );
+    if (!m) {
+        m = std::make_shared<const IndexedMesh>( tris );
+        std::atomic_store( &mesh, m );
+    }
+    return m;
+}
+
+void STLSurf::setMesh(std::shared_ptr<const IndexedMesh> m) {
+    assert( m->size() == tris.size() );
+    std::atomic_store( &store, std::shared_ptr<const TriangleStore>() );
+    std::atomic_store( &mesh, m );
+}
+
+void STLSurf::clearCache() {
+    indexCache.clear();
+    std::atomic_store( &store, std::shared_ptr<const TriangleStore>() );
+    std::atomic_store( &mesh, std::shared_ptr<const IndexedMesh>() );
+}
+
 void STLSurf::addTriangle(const Triangle &t) {
     
     // some sanity-checking:
@@ -38,9 +78,19 @@ void STLSurf::addTriangle(const Triangle &t) {
     
     tris.push_back(t);
     bb.addTriangle(t);
+    clearCache();
     return;
 }
 
+void STLSurf::addTriangles(std::list<Triangle>& t, const Bbox& tbb) {
+    if ( t.empty() )
+        return;
+    tris.splice( tris.end(), t );
+    bb.addPoint( tbb.minpt );
+    bb.addPoint( tbb.maxpt );
+    clearCache();
+}
+
 void STLSurf::rotate(double xr, double yr, double zr) {
     //std::cout << " before " << t << "\n";
     bb.clear();
@@ -52,6 +102,7 @@ void STLSurf::rotate(double xr, double yr, double zr) {
         //std::cin >> c;
         bb.addTriangle(t);
     } 
+    clearCache();
 }
 
 unsigned int STLSurf::size() const {
@@ -22,9 +22,13 @@
 #define STLSURF_H
 
 #include <list>
+#include <memory>
 
 #include "triangle.hpp"
 #include "bbox.hpp"
+#include "indexcache.hpp"
+#include "indexedmesh.hpp"
+#include "trianglestore.hpp"
 
 namespace ocl
 {
@@ -39,20 +43,44 @@ class STLSurf {
     public:
         /// Create an empty STL-surface
         STLSurf() {};
+        /// copy constructor. Copies the triangles, but not the cached data derived from them.
+        STLSurf(const STLSurf& s) : tris(s.tris), bb(s.bb) {}
+        /// assignment. Copies the triangles, but not the cached data derived from them.
+        STLSurf& operator=(const STLSurf& s);
         /// destructor
         virtual ~STLSurf() {};
         /// add Triangle t to this surface
         void addTriangle(const Triangle& t);
+        /// move the triangles of t to the end of this surface, leaving t empty. tbb is the bounding-box of t.
+        void addTriangles(std::list<Triangle>& t, const Bbox& tbb);
         /// return number of triangles in surface
         unsigned int size() const;
         /// call Triangle::rotate on all triangles
         void rotate(double xr,double yr, double zr);
+        /// return the triangles as structure-of-arrays. Built on the first call, and
+        /// shared until addTriangle() or rotate() changes the surface.
+        std::shared_ptr<const TriangleStore> getStore() const;
+        /// return the triangles as an IndexedMesh, with shared vertices and edges. Set by STLReader,
+        /// or built with exact welding on the first call. Shared until addTriangle() or rotate() changes the surface.
+        std::shared_ptr<const IndexedMesh> getMesh() const;
+        /// set the mesh returned by getMesh(). Triangle i of mesh must be the i:th of tris.
+        void setMesh(std::shared_ptr<const IndexedMesh> mesh);
         /// list of Triangles in this surface
         std::list<Triangle> tris; 
         /// bounding-box
         Bbox bb;
+        /// spatial indexes over tris, shared by all operations on this surface.
+        mutable IndexCache<Triangle> indexCache;
+        /// drop indexCache, the TriangleStore and the IndexedMesh. Called by addTriangle() and rotate(),
+        /// code that changes tris directly must call it too.
+        void clearCache();
         /// STLSurf string repr
         friend std::ostream &operator<<(std::ostream& stream, const STLSurf s);
+    private:
+        /// the structure-of-arrays copy of tris, see getStore()
+        mutable std::shared_ptr<const TriangleStore> store;
+        /// the mesh of tris, see getMesh()
+        mutable std::shared_ptr<const IndexedMesh> mesh;
 };
 
 } // end namespace
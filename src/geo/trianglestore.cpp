@@ -0,0 +1,336 @@
+/*  $Id$
+ *
+ *  Copyright (c) 2010-2011 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *
+ *  This file is part of OpenCAMlib
+ *  (see https://github.com/aewallin/opencamlib).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+#include <boost/foreach.hpp>
+
+#include "trianglestore.hpp"
+
+// SIMD versions of TriangleStore::filter() and liftBounds(), selected at runtime with the GCC/clang CPU-detection builtins.
+// Other compilers and CPUs use the scalar version.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #define OCL_X86_SIMD
+    #include <immintrin.h>
+#endif
+
+namespace ocl
+{
+
+/// signature of the filter() implementations. q is { xmin, xmax, ymin, ymax, z }.
+/// Writes the surviving ids to out and returns how many there are.
+typedef unsigned int (*FilterFunction)(const TriangleStore& ts, const unsigned int* ids, unsigned int n,
+                                       const double* q, unsigned int* out);
+
+static unsigned int filter_scalar(const TriangleStore& ts, const unsigned int* ids, unsigned int n,
+                                  const double* q, unsigned int* out) {
+    unsigned int m = 0;
+    for (unsigned int k=0; k<n; ++k) {
+        unsigned int i = ids[k];
+        bool reject = ( ts.maxx[i] < q[0] ) || ( ts.minx[i] > q[1] ) || 
+                      ( ts.maxy[i] < q[2] ) || ( ts.miny[i] > q[3] );
+        out[m] = i;
+        m += ( !reject && ( q[4] < ts.maxz[i] ) );
+    }
+    return m;
+}
+
+#ifdef OCL_X86_SIMD
+__attribute__((target("sse2")))
+static unsigned int filter_sse2(const TriangleStore& ts, const unsigned int* ids, unsigned int n,
+                                const double* q, unsigned int* out) {
+    const __m128d xmin = _mm_set1_pd(q[0]);
+    const __m128d xmax = _mm_set1_pd(q[1]);
+    const __m128d ymin = _mm_set1_pd(q[2]);
+    const __m128d ymax = _mm_set1_pd(q[3]);
+    const __m128d z    = _mm_set1_pd(q[4]);
+    unsigned int m = 0;
+    unsigned int k = 0;
+    for ( ; k+2<=n; k+=2) {
+        const unsigned int i0 = ids[k];
+        const unsigned int i1 = ids[k+1];
+        __m128d reject = _mm_or_pd( _mm_cmplt_pd( _mm_set_pd(ts.maxx[i1], ts.maxx[i0]), xmin ),
+                                    _mm_cmpgt_pd( _mm_set_pd(ts.minx[i1], ts.minx[i0]), xmax ) );
+        reject = _mm_or_pd( reject, _mm_cmplt_pd( _mm_set_pd(ts.maxy[i1], ts.maxy[i0]), ymin ) );
+        reject = _mm_or_pd( reject, _mm_cmpgt_pd( _mm_set_pd(ts.miny[i1], ts.miny[i0]), ymax ) );
+        __m128d keep = _mm_andnot_pd( reject, _mm_cmplt_pd( z, _mm_set_pd(ts.maxz[i1], ts.maxz[i0]) ) );
+        int mask = _mm_movemask_pd( keep );
+        out[m] = i0;
+        m += mask & 1;
+        out[m] = i1;
+        m += (mask >> 1) & 1;
+    }
+    return m + filter_scalar( ts, ids+k, n-k, q, out+m );
+}
+
+__attribute__((target("avx2")))
+static unsigned int filter_avx2(const TriangleStore& ts, const unsigned int* ids, unsigned int n,
+                                const double* q, unsigned int* out) {
+    const __m256d xmin = _mm256_set1_pd(q[0]);
+    const __m256d xmax = _mm256_set1_pd(q[1]);
+    const __m256d ymin = _mm256_set1_pd(q[2]);
+    const __m256d ymax = _mm256_set1_pd(q[3]);
+    const __m256d z    = _mm256_set1_pd(q[4]);
+    unsigned int m = 0;
+    unsigned int k = 0;
+    for ( ; k+4<=n; k+=4) {
+        const __m128i vi = _mm_loadu_si128( reinterpret_cast<const __m128i*>(ids+k) );
+        // the ordered, non-signalling compares are false for NaN, as the scalar < and >
+        __m256d reject = _mm256_or_pd( 
+            _mm256_cmp_pd( _mm256_i32gather_pd( &ts.maxx[0], vi, 8 ), xmin, _CMP_LT_OQ ),
+            _mm256_cmp_pd( _mm256_i32gather_pd( &ts.minx[0], vi, 8 ), xmax, _CMP_GT_OQ ) );
+        reject = _mm256_or_pd( reject, _mm256_cmp_pd( _mm256_i32gather_pd( &ts.maxy[0], vi, 8 ), ymin, _CMP_LT_OQ ) );
+        reject = _mm256_or_pd( reject, _mm256_cmp_pd( _mm256_i32gather_pd( &ts.miny[0], vi, 8 ), ymax, _CMP_GT_OQ ) );
+        __m256d keep = _mm256_andnot_pd( reject, 
+                            _mm256_cmp_pd( z, _mm256_i32gather_pd( &ts.maxz[0], vi, 8 ), _CMP_LT_OQ ) );
+        int mask = _mm256_movemask_pd( keep );
+        for (int b=0; b<4; ++b) { // compact, keeping the order of ids
+            out[m] = ids[k+b];
+            m += (mask >> b) & 1;
+        }
+    }
+    return m + filter_scalar( ts, ids+k, n-k, q, out+m );
+}
+#endif
+
+/// the filter() implementation for this CPU
+struct FilterImplementation {
+    FilterImplementation() : function(filter_scalar), name("scalar") {
+#ifdef OCL_X86_SIMD
+        __builtin_cpu_init();
+        if ( __builtin_cpu_supports("avx2") ) {
+            function = filter_avx2;
+            name = "avx2";
+        } else if ( __builtin_cpu_supports("sse2") ) {
+            function = filter_sse2;
+            name = "sse2";
+        }
+#endif
+    }
+    /// the selected function
+    FilterFunction function;
+    /// name of the selected function
+    const char* name;
+};
+
+/// return the filter() implementation, selected on the first call
+static const FilterImplementation& filter_implementation() {
+    static const FilterImplementation impl;
+    return impl;
+}
+
+/// relative rounding margin of liftBounds(). float has 24 bits, so this is about 160 times the
+/// rounding error of the ten or so operations in the bound.
+static const float BOUND_MARGIN = 1E-5f;
+
+/// signature of the liftBounds() implementations. q is { x, y, flat, round, |x|+|y|+radius }.
+typedef void (*BoundFunction)(const TriangleStore& ts, const unsigned int* ids, unsigned int n,
+                              const float* q, float* out);
+
+// the cutter at (x,y) only touches points of the plane within its radius r, where the plane is at most
+// g*d above its height at (x,y), d being the xy-distance. The cl.z from such a point is at most
+// z(x,y) + g*d - height(d), and over d in [0,r] this is bounded by flat*g + round*(sqrt(1+g^2)-1).
+static void bounds_scalar(const TriangleStore& ts, const unsigned int* ids, unsigned int n,
+                          const float* q, float* out) {
+    for (unsigned int k=0; k<n; ++k) {
+        unsigned int i = ids[k];
+        const float g = ts.pg[i];
+        const float z = ts.pz[i] + ts.pa[i]*( q[0]-ts.px[i] ) + ts.pb[i]*( q[1]-ts.py[i] );
+        const float lift = q[2]*g + q[3]*( std::sqrt( 1.0f + g*g ) - 1.0f );
+        out[k] = z + lift + BOUND_MARGIN*( ts.pm[i] + q[4]*( 1.0f + g ) );
+    }
+}
+
+#ifdef OCL_X86_SIMD
+__attribute__((target("avx2")))
+static void bounds_avx2(const TriangleStore& ts, const unsigned int* ids, unsigned int n,
+                        const float* q, float* out) {
+    const __m256 x     = _mm256_set1_ps(q[0]);
+    const __m256 y     = _mm256_set1_ps(q[1]);
+    const __m256 flat  = _mm256_set1_ps(q[2]);
+    const __m256 round = _mm256_set1_ps(q[3]);
+    const __m256 mag   = _mm256_set1_ps(q[4]);
+    const __m256 one   = _mm256_set1_ps(1.0f);
+    const __m256 eps   = _mm256_set1_ps(BOUND_MARGIN);
+    unsigned int k = 0;
+    for ( ; k+8<=n; k+=8) {
+        const __m256i vi = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(ids+k) );
+        const __m256 g = _mm256_i32gather_ps( &ts.pg[0], vi, 4 );
+        __m256 z = _mm256_add_ps( _mm256_i32gather_ps( &ts.pz[0], vi, 4 ),
+                                  _mm256_mul_ps( _mm256_i32gather_ps( &ts.pa[0], vi, 4 ),
+                                                 _mm256_sub_ps( x, _mm256_i32gather_ps( &ts.px[0], vi, 4 ) ) ) );
+        z = _mm256_add_ps( z, _mm256_mul_ps( _mm256_i32gather_ps( &ts.pb[0], vi, 4 ),
+                                             _mm256_sub_ps( y, _mm256_i32gather_ps( &ts.py[0], vi, 4 ) ) ) );
+        const __m256 lift = _mm256_add_ps( _mm256_mul_ps( flat, g ),
+                                _mm256_mul_ps( round, _mm256_sub_ps( _mm256_sqrt_ps( _mm256_add_ps( one, _mm256_mul_ps(g, g) ) ), one ) ) );
+        const __m256 margin = _mm256_mul_ps( eps, _mm256_add_ps( _mm256_i32gather_ps( &ts.pm[0], vi, 4 ),
+                                                                 _mm256_mul_ps( mag, _mm256_add_ps( one, g ) ) ) );
+        _mm256_storeu_ps( out+k, _mm256_add_ps( _mm256_add_ps( z, lift ), margin ) );
+    }
+    bounds_scalar( ts, ids+k, n-k, q, out+k );
+}
+#endif
+
+/// the liftBounds() implementation for this CPU
+struct BoundImplementation {
+    BoundImplementation() : function(bounds_scalar), name("scalar") {
+#ifdef OCL_X86_SIMD
+        __builtin_cpu_init();
+        if ( __builtin_cpu_supports("avx2") ) {
+            function = bounds_avx2;
+            name = "avx2";
+        }
+#endif
+    }
+    /// the selected function
+    BoundFunction function;
+    /// name of the selected function
+    const char* name;
+};
+
+/// return the liftBounds() implementation, selected on the first call
+static const BoundImplementation& bound_implementation() {
+    static const BoundImplementation impl;
+    return impl;
+}
+
+TriangleStore::TriangleStore(const std::list<Triangle>& tris, std::shared_ptr<const IndexedMesh> m) : mesh(m) {
+    unsigned int N = tris.size();
+    assert( mesh->size() == N );
+    tri.reserve(N);
+    for (int k=0;k<3;k++) {
+        x[k].reserve(N);
+        y[k].reserve(N);
+        z[k].reserve(N);
+    }
+    minx.reserve(N); maxx.reserve(N);
+    miny.reserve(N); maxy.reserve(N);
+    minz.reserve(N); maxz.reserve(N);
+    px.reserve(N); py.reserve(N); pz.reserve(N);
+    pa.reserve(N); pb.reserve(N); pg.reserve(N); pm.reserve(N);
+    BOOST_FOREACH(const Triangle& t, tris) {
+        tri.push_back(&t);
+        for (int k=0;k<3;k++) {
+            x[k].push_back( t.p[k].x );
+            y[k].push_back( t.p[k].y );
+            z[k].push_back( t.p[k].z );
+        }
+        minx.push_back( t.bb.minpt.x );
+        maxx.push_back( t.bb.maxpt.x );
+        miny.push_back( t.bb.minpt.y );
+        maxy.push_back( t.bb.maxpt.y );
+        minz.push_back( t.bb.minpt.z );
+        maxz.push_back( t.bb.maxpt.z );
+        // the plane that MillingCutter::facetDrop() uses, through vertex 0 with normal t.n
+        const double a = -t.n.x/t.n.z;
+        const double b = -t.n.y/t.n.z;
+        const double g = std::sqrt( a*a + b*b );
+        px.push_back( (float)t.p[0].x );
+        py.push_back( (float)t.p[0].y );
+        if ( std::isfinite(g) && g < 1E6 ) {
+            pz.push_back( (float)t.p[0].z );
+            pa.push_back( (float)a );
+            pb.push_back( (float)b );
+            pg.push_back( (float)g );
+        } else { // vertical, or a degenerate triangle with a NaN normal
+            pz.push_back( std::numeric_limits<float>::infinity() );
+            pa.push_back( 0.0f );
+            pb.push_back( 0.0f );
+            pg.push_back( 0.0f );
+        }
+        // the facet extent is included for the horizontal-plane special case of facetDrop(),
+        // which uses the height of vertex 0 for planes that are horizontal within isZero_tol()
+        const double extent = fabs(t.p[0].x) + fabs(t.p[0].y) + (t.bb.maxpt.x-t.bb.minpt.x) + (t.bb.maxpt.y-t.bb.minpt.y);
+        pm.push_back( (float)( 1.0 + fabs(t.p[0].z) + extent*( 1.0 + pg.back() ) ) );
+    }
+    // the z-extent index for zSlab()
+    zorder.resize(N);
+    for (unsigned int i=0; i<N; ++i)
+        zorder[i] = i;
+    std::sort( zorder.begin(), zorder.end(), [this](unsigned int a, unsigned int b) {
+        return minz[a] < minz[b] || ( minz[a] == minz[b] && a < b );
+    } );
+    zblockmax.assign( (N+ZBLOCK-1)/ZBLOCK, -std::numeric_limits<double>::infinity() );
+    for (unsigned int k=0; k<N; ++k)
+        zblockmax[k/ZBLOCK] = std::max( zblockmax[k/ZBLOCK], maxz[ zorder[k] ] );
+}
+
+// zorder[0] to zorder[end-1] start at or below zmax. A block whose highest triangle
+// ends below zmin is skipped, the others are tested one triangle at a time.
+void TriangleStore::zSlab(double zmin, double zmax, std::vector<unsigned int>& out) const {
+    out.clear();
+    const unsigned int end = std::upper_bound( zorder.begin(), zorder.end(), zmax, [this](double z, unsigned int i) {
+        return z < minz[i];
+    } ) - zorder.begin();
+    for (unsigned int b=0; b*ZBLOCK<end; ++b) {
+        if ( zblockmax[b] < zmin )
+            continue;
+        const unsigned int kend = std::min( (b+1)*ZBLOCK, end );
+        for (unsigned int k=b*ZBLOCK; k<kend; ++k) {
+            if ( maxz[ zorder[k] ] >= zmin )
+                out.push_back( zorder[k] );
+        }
+    }
+    std::sort( out.begin(), out.end() );
+}
+
+void TriangleStore::filter(const std::vector<unsigned int>& ids, double xmin, double xmax, double ymin, double ymax,
+                           double z, std::vector<unsigned int>& out) const {
+    out.resize( ids.size() );
+    if ( ids.empty() )
+        return;
+    const double q[5] = { xmin, xmax, ymin, ymax, z };
+    unsigned int m = filter_implementation().function( *this, &ids[0], ids.size(), q, &out[0] );
+    out.resize( m );
+}
+
+std::string TriangleStore::filterType() {
+    return filter_implementation().name;
+}
+
+void TriangleStore::liftBounds(const std::vector<unsigned int>& ids, double x, double y, double radius,
+                               double flat, double round, std::vector<float>& bound) const {
+    bound.resize( ids.size() );
+    if ( ids.empty() )
+        return;
+    const float q[5] = { (float)x, (float)y, (float)flat, (float)round, 
+                         (float)( fabs(x) + fabs(y) + radius ) };
+    bound_implementation().function( *this, &ids[0], ids.size(), q, &bound[0] );
+}
+
+std::string TriangleStore::liftBoundsType() {
+    return bound_implementation().name;
+}
+
+std::size_t TriangleStore::bytes() const {
+    return tri.size()*( sizeof(const Triangle*) + (9+6)*sizeof(double) + 7*sizeof(float) + sizeof(unsigned int) )
+           + zblockmax.size()*sizeof(double);
+}
+
+std::size_t TriangleStore::listBytes() const {
+    return tri.size()*( sizeof(Triangle) + 2*sizeof(void*) ); // a std::list node has two links
+}
+
+} // end namespace
+// end file trianglestore.cpp
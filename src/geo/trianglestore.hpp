@@ -0,0 +1,131 @@
+/*  $Id$
+ *
+ *  Copyright (c) 2010-2011 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *
+ *  This file is part of OpenCAMlib
+ *  (see https://github.com/aewallin/opencamlib).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef TRIANGLESTORE_H
+#define TRIANGLESTORE_H
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "triangle.hpp"
+#include "indexedmesh.hpp"
+
+namespace ocl
+{
+
+///
+/// \brief the triangles of an STLSurf stored as structure-of-arrays
+///
+/// Entry i of each array belongs to the i:th triangle of STLSurf::tris, which is also
+/// the position returned by the SpatialIndex searches that fill a std::vector<unsigned int>.
+/// The data is copied from the Triangles, so tests on the arrays give exactly
+/// the same results as tests on the Triangles. Loops over the arrays touch
+/// only the data they need, and can be vectorized by the compiler.
+/// The store is kept in addition to STLSurf::tris and the IndexedMesh, not instead
+/// of them, so it adds bytes() to the memory of the surface, see listBytes().
+class TriangleStore {
+    public:
+        /// an empty store
+        TriangleStore() {}
+        /// build the store from a list of triangles and their mesh, see STLSurf::getStore()
+        TriangleStore(const std::list<Triangle>& tris, std::shared_ptr<const IndexedMesh> mesh);
+        /// return number of triangles
+        unsigned int size() const { return tri.size(); }
+        /// return triangle i, for the exact drop/push-cutter tests
+        const Triangle& triangle(unsigned int i) const { return *tri[i]; }
+        /// return an estimate of the memory used by the arrays, in bytes, not counting the mesh
+        std::size_t bytes() const;
+        /// return an estimate of the memory used by the std::list<Triangle> the store was built from, in bytes
+        std::size_t listBytes() const;
+        /// copy to out the triangles of ids whose bounding-box overlaps [xmin, xmax] x [ymin, ymax]
+        /// in the XY-plane and reaches above z. These are the MillingCutter::overlaps() and
+        /// CLPoint::below() tests. out keeps the order of ids. Uses AVX2 or SSE2 when the CPU has them.
+        void filter(const std::vector<unsigned int>& ids, double xmin, double xmax, double ymin, double ymax,
+                    double z, std::vector<unsigned int>& out) const;
+        /// return the name of the filter() implementation in use: "avx2", "sse2" or "scalar"
+        static std::string filterType();
+        /// write to bound[k] an upper bound for the cl.z that MillingCutter::dropCutter() can give
+        /// for a cutter at (x, y) against triangle ids[k], see MillingCutter::slopeBound().
+        /// flat and round are the coefficients from slopeBound(), and radius is the cutter radius.
+        /// The bounds are computed in float, with a margin that covers the rounding of both this and
+        /// the exact drop-cutter, so a triangle with bound[k] <= cl.z cannot lift cl.
+        /// Uses AVX2 when the CPU has it.
+        void liftBounds(const std::vector<unsigned int>& ids, double x, double y, double radius,
+                        double flat, double round, std::vector<float>& bound) const;
+        /// return the name of the liftBounds() implementation in use: "avx2" or "scalar"
+        static std::string liftBoundsType();
+        /// place in out the triangles whose z-range [minz, maxz] overlaps [zmin, zmax], in list order.
+        /// Uses zorder and zblockmax, so triangles far below zmin are skipped a block at a time,
+        /// and triangles above zmax are not visited at all.
+        void zSlab(double zmin, double zmax, std::vector<unsigned int>& out) const;
+
+    // DATA
+        /// the triangles, in list order
+        std::vector<const Triangle*> tri;
+        /// vertex k of triangle i is ( x[k][i], y[k][i], z[k][i] )
+        std::vector<double> x[3];
+        /// y-coordinates of the vertices
+        std::vector<double> y[3];
+        /// z-coordinates of the vertices
+        std::vector<double> z[3];
+        /// bounding-box of triangle i is [minx[i], maxx[i]] x [miny[i], maxy[i]] x [minz[i], maxz[i]]
+        std::vector<double> minx;
+        /// bounding-box maximum x
+        std::vector<double> maxx;
+        /// bounding-box minimum y
+        std::vector<double> miny;
+        /// bounding-box maximum y
+        std::vector<double> maxy;
+        /// bounding-box minimum z
+        std::vector<double> minz;
+        /// bounding-box maximum z
+        std::vector<double> maxz;
+        /// the plane of triangle i, in float for liftBounds(), is
+        /// z = pz[i] + pa[i]*(x-px[i]) + pb[i]*(y-py[i]). ( px[i], py[i], pz[i] ) is vertex 0.
+        /// pz[i] is +infinity for vertical and degenerate triangles, which have no bound.
+        std::vector<float> px;
+        /// y-coordinate of the plane origin
+        std::vector<float> py;
+        /// z-coordinate of the plane origin, or +infinity
+        std::vector<float> pz;
+        /// dz/dx of the plane
+        std::vector<float> pa;
+        /// dz/dy of the plane
+        std::vector<float> pb;
+        /// the slope of the plane, sqrt( pa[i]^2 + pb[i]^2 )
+        std::vector<float> pg;
+        /// the magnitude of the triangle coordinates, that the rounding margin of liftBounds() is relative to
+        std::vector<float> pm;
+        /// the triangles sorted by minz, ties in list order
+        std::vector<unsigned int> zorder;
+        /// zblockmax[b] is the highest maxz of the triangles zorder[b*ZBLOCK] to zorder[(b+1)*ZBLOCK-1]
+        std::vector<double> zblockmax;
+        /// the number of zorder entries covered by one zblockmax
+        static const unsigned int ZBLOCK = 64;
+        /// the vertices and edges shared by the triangles. Triangle i of the mesh is tri[i].
+        std::shared_ptr<const IndexedMesh> mesh;
+};
+
+} // end namespace
+#endif
+// end file trianglestore.hpp
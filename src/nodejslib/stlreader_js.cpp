@@ -34,5 +34,8 @@ STLReaderJS::STLReaderJS(const Napi::CallbackInfo &info) : Napi::ObjectWrap<STLR
     std::wstring filepathWstring;
     std::string filepathStr = filepath.Utf8Value();
     filepathWstring.assign(filepathStr.begin(), filepathStr.end());
-    ocl::STLReader(filepathWstring, *surfaceInstance);
+    if (length > 2)
+        ocl::STLReader(filepathWstring, *surfaceInstance, info[2].As<Napi::Number>().DoubleValue());
+    else
+        ocl::STLReader(filepathWstring, *surfaceInstance);
 }
\ No newline at end of file
@@ -37,7 +37,7 @@ class AdaptivePathDropCutter_py : public AdaptivePathDropCutter {
         boost::python::list getCLPoints_py() {
             //std::cout << " apdc_py::getCLPoints_py()...";
             boost::python::list plist;
-            BOOST_FOREACH(CLPoint p, clpoints) {
+            BOOST_FOREACH(const CLPoint& p, clpoints) {
                 plist.append(p);
             }
             //std::cout << " DONE.\n";
@@ -36,11 +36,34 @@ class BatchDropCutter_py : public BatchDropCutter {
         /// return CL-points to Python
         boost::python::list getCLPoints_py() {
             boost::python::list plist;
-            BOOST_FOREACH(CLPoint p, *clpoints) {
+            BOOST_FOREACH(const CLPoint& p, *clpoints) {
                 plist.append(p);
             }
             return plist;
         };
+        /// runStream() with Python callables. source(n) returns a list of at most n CLPoints,
+        /// an empty list ends the input. A longer list raises ValueError, since it would break
+        /// the memory bound of runStream(). sink(list) gets each finished chunk in input order.
+        void runStream_py(boost::python::object source, boost::python::object sink) {
+            runStream( 
+                [&source](std::vector<CLPoint>& chunk, unsigned int n) {
+                    boost::python::list plist = boost::python::extract<boost::python::list>( source(n) );
+                    if ( boost::python::len(plist) > (long)n ) {
+                        PyErr_SetString( PyExc_ValueError, "runStream(): source(n) returned more than n points" );
+                        boost::python::throw_error_already_set();
+                    }
+                    for (int m=0; m<boost::python::len(plist); ++m)
+                        chunk.push_back( boost::python::extract<CLPoint>( plist[m] ) );
+                    return !chunk.empty();
+                },
+                [&sink](const std::vector<CLPoint>& chunk) {
+                    boost::python::list plist;
+                    BOOST_FOREACH(const CLPoint& p, chunk) {
+                        plist.append(p);
+                    }
+                    sink(plist);
+                } );
+        };
         /// return triangles under cutter to Python. Not for CAM-algorithms, 
         /// more for visualization and demonstration.
         boost::python::list getTrianglesUnderCutter(CLPoint& cl, MillingCutter& cutter) {
@@ -0,0 +1,65 @@
+/*  $Id$
+ * 
+ *  Copyright (c) 2010 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *  
+ *  This file is part of OpenCAMlib 
+ *  (see https://github.com/aewallin/opencamlib).
+ *  
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MULTIWATERLINE_PY_H
+#define MULTIWATERLINE_PY_H
+
+#include <boost/python.hpp>
+#include <boost/foreach.hpp>
+
+#include "multiwaterline.hpp"
+
+namespace ocl
+{
+
+/// Python wrapper for MultiWaterline
+class MultiWaterline_py : public MultiWaterline {
+    public:
+        MultiWaterline_py() : MultiWaterline() {}
+        /// return the loops to python, as a list with a list of loops for each z-height
+        boost::python::list py_getLoops() const {
+            boost::python::list level_list;
+            BOOST_FOREACH( const std::vector< std::vector<Point> >& level, this->loops ) {
+                boost::python::list loop_list;
+                BOOST_FOREACH( const std::vector<Point>& loop, level ) {
+                    boost::python::list point_list;
+                    BOOST_FOREACH( const Point& p, loop ) {
+                        point_list.append( p );
+                    }
+                    loop_list.append(point_list);
+                }
+                level_list.append(loop_list);
+            }
+            return level_list;
+        }
+        /// return the z-heights to python
+        boost::python::list py_getZ() const {
+            boost::python::list zlist;
+            BOOST_FOREACH( double z, this->zlevels ) {
+                zlist.append( z );
+            }
+            return zlist;
+        }
+};
+
+} // end namespace
+
+#endif
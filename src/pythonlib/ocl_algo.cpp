@@ -27,6 +27,7 @@
 #include "weave_py.hpp"           
 #include "waterline_py.hpp"      
 #include "adaptivewaterline_py.hpp"  
+#include "multiwaterline_py.hpp"
 #include "lineclfilter_py.hpp"    
 #include "numeric.hpp"
 
@@ -74,6 +75,8 @@ void export_algo() {
         .def("getThreads", &BatchPushCutter_py::getThreads)
         .def("setBucketSize", &BatchPushCutter_py::setBucketSize)
         .def("getBucketSize", &BatchPushCutter_py::getBucketSize)
+        .def("setIndexType", &BatchPushCutter_py::setIndexType)
+        .def("getIndexType", &BatchPushCutter_py::getIndexType)
         .def("setXDirection", &BatchPushCutter_py::setXDirection)
         .def("setYDirection", &BatchPushCutter_py::setYDirection)
     ;
@@ -113,6 +116,8 @@ void export_algo() {
         .def("getLoops", &Waterline_py::py_getLoops)
         .def("setThreads", &Waterline_py::setThreads)
         .def("getThreads", &Waterline_py::getThreads)
+        .def("setIndexType", &Waterline_py::setIndexType)
+        .def("getIndexType", &Waterline_py::getIndexType)
         .def("getXFibers", &Waterline_py::py_getXFibers)
         .def("getYFibers", &Waterline_py::py_getYFibers)
         
@@ -132,10 +137,30 @@ void export_algo() {
         .def("getLoops", &AdaptiveWaterline_py::py_getLoops)
         .def("setThreads", &AdaptiveWaterline_py::setThreads)
         .def("getThreads", &AdaptiveWaterline_py::getThreads)
+        .def("setIndexType", &AdaptiveWaterline_py::setIndexType)
+        .def("getIndexType", &AdaptiveWaterline_py::getIndexType)
         .def("getXFibers", &AdaptiveWaterline_py::getXFibers)
         .def("getYFibers", &AdaptiveWaterline_py::getYFibers)
     ;
     
+    bp::class_<MultiWaterline>("MultiWaterline_base")
+    ;
+    bp::class_<MultiWaterline_py, bp::bases<MultiWaterline> >("MultiWaterline")
+        .def("setCutter", &MultiWaterline_py::setCutter)
+        .def("setSTL", &MultiWaterline_py::setSTL)
+        .def("appendZ", &MultiWaterline_py::appendZ)
+        .def("getZ", &MultiWaterline_py::py_getZ)
+        .def("setSampling", &MultiWaterline_py::setSampling)
+        .def("run", &MultiWaterline_py::run)
+        .def("run2", &MultiWaterline_py::run2)
+        .def("reset", &MultiWaterline_py::reset)
+        .def("getLoops", &MultiWaterline_py::py_getLoops)
+        .def("setThreads", &MultiWaterline_py::setThreads)
+        .def("getThreads", &MultiWaterline_py::getThreads)
+        .def("setIndexType", &MultiWaterline_py::setIndexType)
+        .def("getIndexType", &MultiWaterline_py::getIndexType)
+    ;
+    
     bp::enum_<weave::VertexType>("WeaveVertexType")
         .value("CL", weave::CL)
         .value("CL_DONE",weave::CL_DONE)
@@ -22,6 +22,7 @@
 #include <boost/python.hpp>
 
 #include "batchdropcutter_py.hpp" 
+#include "heightmapdropcutter_py.hpp"
 #include "pathdropcutter_py.hpp"  
 #include "adaptivepathdropcutter_py.hpp"  
 
@@ -36,6 +37,13 @@ namespace bp = boost::python;
 
 void export_dropcutter() {
 
+    bp::enum_<IndexType>("IndexType")
+        .value("KDTREE", KDTREE)
+        .value("FLAT_KDTREE", FLAT_KDTREE)
+        .value("SAH_KDTREE", SAH_KDTREE)
+        .value("BVH4", BVH4)
+        .export_values()
+    ;
     bp::class_<BatchDropCutter>("BatchDropCutter_base")
     ;
     bp::class_<BatchDropCutter_py, bp::bases<BatchDropCutter> >("BatchDropCutter")
@@ -50,9 +58,39 @@ void export_dropcutter() {
         .def("getCalls", &BatchDropCutter_py::getCalls)
         .def("getBucketSize", &BatchDropCutter_py::getBucketSize)
         .def("setBucketSize", &BatchDropCutter_py::setBucketSize)
+        .def("setIndexType", &BatchDropCutter_py::setIndexType)
+        .def("getIndexType", &BatchDropCutter_py::getIndexType)
+        .def("setZSort", &BatchDropCutter_py::setZSort)
+        .def("getZSort", &BatchDropCutter_py::getZSort)
+        .def("setTileSize", &BatchDropCutter_py::setTileSize)
+        .def("getTileSize", &BatchDropCutter_py::getTileSize)
+        .def("setUniqueEdges", &BatchDropCutter_py::setUniqueEdges)
+        .def("getUniqueEdges", &BatchDropCutter_py::getUniqueEdges)
+        .def("runStream", &BatchDropCutter_py::runStream_py)
+        .def("setChunkSize", &BatchDropCutter_py::setChunkSize)
+        .def("getChunkSize", &BatchDropCutter_py::getChunkSize)
     ;
 
 
+    bp::class_<HeightmapDropCutter>("HeightmapDropCutter_base")
+    ;
+    bp::class_<HeightmapDropCutter_py, bp::bases<HeightmapDropCutter> >("HeightmapDropCutter")
+        .def("run", &HeightmapDropCutter_py::run)
+        .def("getCLPoints", &HeightmapDropCutter_py::getCLPoints_py)
+        .def("getHeights", &HeightmapDropCutter_py::getHeights_py)
+        .def("setSTL", &HeightmapDropCutter_py::setSTL)
+        .def("setCutter", &HeightmapDropCutter_py::setCutter)
+        .def("setThreads", &HeightmapDropCutter_py::setThreads)
+        .def("getThreads", &HeightmapDropCutter_py::getThreads)
+        .def("setSampling", &HeightmapDropCutter_py::setSampling)
+        .def("getSampling", &HeightmapDropCutter_py::getSampling)
+        .def("setGrid", &HeightmapDropCutter_py::setGrid)
+        .def("getXSize", &HeightmapDropCutter_py::getXSize)
+        .def("getYSize", &HeightmapDropCutter_py::getYSize)
+        .def("getZ", &HeightmapDropCutter_py::getZ)
+        .def("setZ", &HeightmapDropCutter_py::setZ)
+        .def("getCalls", &HeightmapDropCutter_py::getCalls)
+    ;
     bp::class_<PathDropCutter>("PathDropCutter_base")
     ;
     bp::class_<PathDropCutter_py , bp::bases<PathDropCutter> >("PathDropCutter")
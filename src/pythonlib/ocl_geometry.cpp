@@ -131,6 +131,8 @@ void export_geometry() {
     ;
     bp::class_<STLReader>("STLReader")
         .def(bp::init<const std::wstring&, STLSurf&>())
+        .def(bp::init<const std::wstring&, STLSurf&, double>())
+        .def(bp::init<const std::wstring&, STLSurf&, double, unsigned int>())
     ;
     bp::class_<Bbox>("Bbox")
         .def("isInside", &Bbox::isInside )
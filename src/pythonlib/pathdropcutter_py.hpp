@@ -37,7 +37,7 @@ class PathDropCutter_py : public PathDropCutter {
         /// return a list of CL-points to python
         boost::python::list getCLPoints_py() {
             boost::python::list plist;
-            BOOST_FOREACH(CLPoint p, clpoints) {
+            BOOST_FOREACH(const CLPoint& p, clpoints) {
                 plist.append(p);
             }
             return plist;